@@ -0,0 +1,11 @@
+#include "ai.h"
+
+// greedy policy: first step of a body-safe shortest path towards the normal
+// food, or the roomiest safe move when the food is cut off
+int ai_choose(PathFinder *pf, const GameState *g) {
+    int dir;
+    if (find_path_to_target(pf, &g->board, &g->snake, g->grow, (g->lastMoveDir + 2) % 4,
+                            g->food.x, g->food.y, &dir))
+        return dir;
+    return ACTION_NONE;
+}
@@ -0,0 +1,9 @@
+#ifndef AI_H
+#define AI_H
+
+#include "game.h"
+#include "path.h"
+
+int ai_choose(PathFinder *pf, const GameState *g);
+
+#endif
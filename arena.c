@@ -0,0 +1,283 @@
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define ARENA_X86 1
+#endif
+
+static const int dx[4] = { 0, 1, 0, -1 };
+static const int dy[4] = { -1, 0, 1, 0 };
+
+static inline int bit_at(const uint64_t *layer, int k) {
+    return (int)((layer[k >> 6] >> (k & 63)) & 1u);
+}
+
+// in bounds and neither wall nor body
+static inline int open_cell(const Board *b, int x, int y) {
+    if (!board_in_bounds(b, x, y)) return 0;
+    int k = y * b->width + x;
+    return !bit_at(b->layer[LAYER_WALL], k) && !bit_at(b->layer[LAYER_SNAKE], k);
+}
+
+// -------------------- fruit and snakes --------------------
+static void place_fruit(Arena *a, int slot) {
+    int x, y;
+    a->fruit[slot] = -1;
+    if (!board_random_free(&a->board, &a->rng, -1, -1, -1, -1, &x, &y)) return;
+    board_set(&a->board, LAYER_FRUIT, x, y);
+    a->fruit[slot] = y * a->board.width + x;
+    a->fruitSlot[a->fruit[slot]] = slot;
+}
+
+static void push_head(Arena *a, int s, int cell) {
+    int w = a->board.width;
+    if (a->length[s] > 0) a->headAt[arena_segment(a, s, 0)] = 0;
+    a->headAt[cell] = s + 1;
+    a->ring[s] = a->ring[s] == 0 ? ARENA_MAX_LEN - 1 : a->ring[s] - 1;
+    a->body[s * ARENA_MAX_LEN + a->ring[s]] = cell;
+    a->length[s]++;
+    a->hx[s] = cell % w; a->hy[s] = cell / w;
+    board_set(&a->board, LAYER_SNAKE, a->hx[s], a->hy[s]);
+}
+
+static void pop_tail(Arena *a, int s) {
+    int w = a->board.width, tail = arena_segment(a, s, a->length[s] - 1);
+    board_clear(&a->board, LAYER_SNAKE, tail % w, tail / w);
+    a->length[s]--;
+}
+
+// one cell on a random free spot with room to move; retried next tick if the board is full
+static void spawn(Arena *a, int s) {
+    for (int attempt = 0; attempt < 8; attempt++) {
+        int x, y;
+        if (!board_random_free(&a->board, &a->rng, -1, -1, -1, -1, &x, &y)) break;
+        int d0 = rng_below(&a->rng, 4);
+        for (int k = 0; k < 4; k++) {
+            int d = (d0 + k) & 3;
+            if (!open_cell(&a->board, x + dx[d], y + dy[d])) continue;
+            a->dir[s] = (unsigned char)d;
+            a->length[s] = 0; a->ring[s] = 0;
+            a->grow[s] = ARENA_START_LEN - 1;
+            a->respawn[s] = 0;
+            push_head(a, s, y * a->board.width + x);
+            a->alive++;
+            return;
+        }
+    }
+    a->respawn[s] = 1;
+}
+
+static void kill(Arena *a, int s, int cause) {
+    a->headAt[a->hy[s] * a->board.width + a->hx[s]] = 0;
+    while (a->length[s] > 0) pop_tail(a, s);
+    a->respawn[s] = ARENA_RESPAWN_TICKS;
+    a->deaths[cause]++;
+    a->alive--;
+}
+
+// -------------------- setup --------------------
+int arena_init(Arena *a, int width, int height, int snakes, int fruits, uint64_t seed, int layout) {
+    memset(a, 0, sizeof(*a));
+    if (width < 4 || height < 4 || (long long)width * height > INT32_MAX / 2) return 0;
+    if (snakes < 1 || snakes > ARENA_MAX_SNAKES) return 0;
+    if (fruits <= 0) fruits = snakes;
+    if (!board_init(&a->board, width, height)) return 0;
+    int cells = width * height;
+    a->count = snakes; a->fruitCount = fruits;
+    a->hx = malloc(sizeof(int) * snakes);
+    a->hy = malloc(sizeof(int) * snakes);
+    a->dir = malloc(snakes);
+    a->length = calloc(snakes, sizeof(int));
+    a->grow = calloc(snakes, sizeof(int));
+    a->score = calloc(snakes, sizeof(int));
+    a->respawn = calloc(snakes, sizeof(int));
+    a->target = calloc(snakes, sizeof(int));
+    a->ring = calloc(snakes, sizeof(int));
+    a->body = malloc(sizeof(int) * snakes * ARENA_MAX_LEN);
+    a->next = malloc(sizeof(int) * snakes);
+    a->blocked = malloc(sizeof(int) * snakes);
+    a->claim = calloc(cells, sizeof(int));
+    a->headAt = calloc(cells, sizeof(int));
+    a->fruitSlot = malloc(sizeof(int) * cells);
+    a->fruit = malloc(sizeof(int) * fruits);
+    if (!a->hx || !a->hy || !a->dir || !a->length || !a->grow || !a->score || !a->respawn || !a->target ||
+        !a->ring || !a->body || !a->next || !a->blocked || !a->claim || !a->headAt || !a->fruitSlot || !a->fruit) {
+        arena_free(a);
+        return 0;
+    }
+
+    rng_seed(&a->rng, seed);
+    if (layout == LAYOUT_DEFAULT) layout = LAYOUT_OPEN;
+    LevelScratch scratch = {0};
+    level_generate(&a->board, &a->rng, layout, cells / ARENA_WALL_DENSITY, width / 2, height / 2, &scratch);
+    level_scratch_free(&scratch);
+    for (int f = 0; f < fruits; f++) place_fruit(a, f);
+    // each snake chases its own fruit slot, so few snakes converge on one cell
+    for (int s = 0; s < snakes; s++) { a->target[s] = s % fruits; spawn(a, s); }
+    return 1;
+}
+
+void arena_free(Arena *a) {
+    free(a->hx); free(a->hy); free(a->dir); free(a->length); free(a->grow); free(a->score);
+    free(a->respawn); free(a->target); free(a->ring); free(a->body); free(a->next); free(a->blocked);
+    free(a->claim); free(a->headAt); free(a->fruitSlot); free(a->fruit);
+    board_free(&a->board);
+    memset(a, 0, sizeof(*a));
+}
+
+// -------------------- built-in AI --------------------
+// could another snake at least as long move its head into (x, y) this tick?
+static int contested(const Arena *a, int i, int x, int y) {
+    const Board *b = &a->board;
+    for (int e = 0; e < 4; e++) {
+        int nx = x + dx[e], ny = y + dy[e];
+        if (!board_in_bounds(b, nx, ny)) continue;
+        int j = a->headAt[ny * b->width + nx] - 1;
+        if (j >= 0 && j != i && a->length[j] >= a->length[i]) return 1;
+    }
+    return 0;
+}
+
+// Greedy towards the snake's fruit: the first of (closer axis, other axis,
+// straight on, turns) that is open, not a dead end and not contested by a
+// rival head, falling back to the first that is open and not a dead end, then
+// to the first open. Reads the board as of the start of the tick, so the
+// order snakes are decided in doesn't matter.
+int arena_ai(const Arena *a, int i) {
+    const Board *b = &a->board;
+    int x = a->hx[i], y = a->hy[i], d = a->dir[i];
+    int t = a->fruit[a->target[i]];
+    int tx = t >= 0 ? t % b->width : x, ty = t >= 0 ? t / b->width : y;
+    int hd = tx > x ? 1 : 3, vd = ty > y ? 2 : 0;
+    int horiz = abs(tx - x) >= abs(ty - y);
+    int order[5] = { horiz ? hd : vd, horiz ? vd : hd, d, (d + 1) & 3, (d + 3) & 3 };
+    int roomy = -1, open = -1;
+    for (int k = 0; k < 5; k++) {
+        int c = order[k];
+        if (c == ((d + 2) & 3) && a->length[i] > 1) continue;
+        int nx = x + dx[c], ny = y + dy[c];
+        if (!open_cell(b, nx, ny)) continue;
+        if (open < 0) open = c;
+        int exits = 0;
+        for (int e = 0; e < 4; e++) exits += open_cell(b, nx + dx[e], ny + dy[e]);
+        if (!exits) continue;
+        if (!contested(a, i, nx, ny)) return c;
+        if (roomy < 0) roomy = c;
+    }
+    return roomy >= 0 ? roomy : open >= 0 ? open : d;
+}
+
+// -------------------- collision batch --------------------
+// blocked[i] = next[i] is off the board (-1) or has a wall or body bit set
+static void test_heads_scalar(Arena *a, int from, int n) {
+    const uint64_t *snake = a->board.layer[LAYER_SNAKE], *wall = a->board.layer[LAYER_WALL];
+    for (int i = from; i < n; i++) {
+        int c = a->next[i];
+        a->blocked[i] = c < 0 || bit_at(snake, c) | bit_at(wall, c);
+    }
+}
+
+#ifdef ARENA_X86
+// Eight heads per step: gather the 32-bit occupancy words of both layers for
+// the eight cells, shift each lane's bit down, and fold in the off-board lanes.
+// The layers are read as arrays of 32-bit words (little-endian x86).
+__attribute__((target("avx2")))
+static int test_heads_avx2(Arena *a, int n) {
+    const int *snake = (const int *)a->board.layer[LAYER_SNAKE], *wall = (const int *)a->board.layer[LAYER_WALL];
+    const __m256i one = _mm256_set1_epi32(1), low5 = _mm256_set1_epi32(31);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i cell = _mm256_loadu_si256((const __m256i *)(a->next + i));
+        __m256i off = _mm256_cmpgt_epi32(_mm256_setzero_si256(), cell);   // cell < 0
+        __m256i safe = _mm256_andnot_si256(off, cell);                      // off-board lanes read word 0
+        __m256i word = _mm256_srli_epi32(safe, 5);
+        __m256i bits = _mm256_or_si256(_mm256_i32gather_epi32(snake, word, 4),
+                                       _mm256_i32gather_epi32(wall, word, 4));
+        bits = _mm256_and_si256(_mm256_srlv_epi32(bits, _mm256_and_si256(safe, low5)), one);
+        _mm256_storeu_si256((__m256i *)(a->blocked + i), _mm256_or_si256(bits, _mm256_and_si256(off, one)));
+    }
+    return i;
+}
+#endif
+
+static void test_heads(Arena *a, int n) {
+    int done = 0;
+#ifdef ARENA_X86
+    static int avx2 = -1;
+    if (avx2 < 0) avx2 = __builtin_cpu_supports("avx2") != 0;
+    if (avx2) done = test_heads_avx2(a, n);
+#endif
+    test_heads_scalar(a, done, n);
+}
+
+// -------------------- tick --------------------
+// Advance every snake one cell. `actions` holds a direction or -1 (keep
+// going) per snake, or is NULL to let the built-in AI steer all of them.
+// Tails move out before heads move in, so a head may follow a tail into the
+// cell it just left. Heads meeting in one cell: the longest snake takes it,
+// and on a tie for longest all of them die.
+void arena_step(Arena *a, const signed char *actions) {
+    Board *b = &a->board;
+    int n = a->count, w = b->width, h = b->height;
+    a->tick++;
+
+    for (int i = 0; i < n; i++) if (a->respawn[i] && --a->respawn[i] == 0) spawn(a, i);
+
+    for (int i = 0; i < n; i++) {
+        if (a->respawn[i]) continue;
+        int d = actions ? actions[i] : arena_ai(a, i);
+        if (d >= 0 && d < 4 && (d != ((a->dir[i] + 2) & 3) || a->length[i] == 1)) a->dir[i] = (unsigned char)d;
+    }
+
+    // next heads, branch-free over the arrays; dead snakes get -1
+    for (int i = 0; i < n; i++) {
+        int x = a->hx[i] + dx[a->dir[i]], y = a->hy[i] + dy[a->dir[i]];
+        int in = ((unsigned)x < (unsigned)w) & ((unsigned)y < (unsigned)h) & (a->respawn[i] == 0);
+        a->next[i] = in ? y * w + x : -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (a->respawn[i]) continue;
+        if (a->grow[i] > 0 && a->length[i] < ARENA_MAX_LEN) a->grow[i]--;
+        else { a->grow[i] = 0; pop_tail(a, i); }
+    }
+
+    test_heads(a, n);
+
+    // head-on: claim[c] is the index + 1 of the longest snake entering c so
+    // far, or -(length + 1) while the longest is tied; order-independent
+    for (int i = 0; i < n; i++) {
+        if (a->respawn[i] || a->blocked[i]) continue;
+        int *c = &a->claim[a->next[i]], len = a->length[i];
+        if (*c == 0) *c = i + 1;
+        else {
+            int best = *c > 0 ? a->length[*c - 1] : -*c - 1;
+            if (len > best) *c = i + 1;
+            else if (len == best) *c = -(len + 1);
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        if (a->respawn[i] || a->blocked[i]) continue;
+        if (a->claim[a->next[i]] != i + 1) a->blocked[i] = 2;
+    }
+    for (int i = 0; i < n; i++) if (a->next[i] >= 0) a->claim[a->next[i]] = 0;
+
+    for (int i = 0; i < n; i++) {
+        if (a->respawn[i]) continue;
+        int c = a->next[i];
+        if (a->blocked[i] == 2) { kill(a, i, ARENA_DEATH_HEAD_ON); continue; }
+        if (a->blocked[i]) {
+            kill(a, i, c < 0 || bit_at(b->layer[LAYER_WALL], c) ? ARENA_DEATH_WALL : ARENA_DEATH_BODY);
+            continue;
+        }
+        push_head(a, i, c);
+        if (bit_at(b->layer[LAYER_FRUIT], c)) {
+            int slot = a->fruitSlot[c];
+            board_clear(b, LAYER_FRUIT, c % w, c / w);
+            a->score[i] += 10;
+            a->grow[i]++;
+            place_fruit(a, slot);
+        }
+    }
+}
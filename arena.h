@@ -0,0 +1,68 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "board.h"
+#include "rng.h"
+#include "level.h"
+
+// Arena mode: many AI snakes sharing one board. Per-snake state is kept as
+// structure-of-arrays, so each phase of a tick (next heads, tails, collision
+// test, moves) is one pass over contiguous arrays. The collision test reads
+// the occupancy bits for a whole batch of heads at once (AVX2 gathers when
+// the CPU has them). Every body is on the board's LAYER_SNAKE, fruit on
+// LAYER_FRUIT; cells are indexed y * width + x.
+#define ARENA_MAX_SNAKES 65536
+#define ARENA_MAX_LEN 64         // body cap; eating at the cap only scores
+#define ARENA_START_LEN 4        // a spawned snake grows to this from one cell
+#define ARENA_RESPAWN_TICKS 20
+#define ARENA_WALL_DENSITY 200   // scattered layouts: one wall per this many cells
+
+// What killed a snake
+enum { ARENA_DEATH_WALL = 0, ARENA_DEATH_BODY, ARENA_DEATH_HEAD_ON, ARENA_DEATHS };
+
+typedef struct Arena {
+    Board board;
+    Rng rng;
+    int count;                // snakes
+    int fruitCount;
+    int alive;
+    long long tick;
+    long long deaths[ARENA_DEATHS];
+
+    // per snake
+    int *hx, *hy;             // head
+    unsigned char *dir;       // 0=UP, 1=RIGHT, 2=DOWN, 3=LEFT
+    int *length;
+    int *grow;                // segments still to add
+    int *score;
+    int *respawn;             // ticks until back on the board; 0 while alive
+    int *target;              // fruit slot the built-in AI chases (fixed per snake)
+    int *ring;                // head slot of each snake's ring in `body`
+    int *body;                // ARENA_MAX_LEN cells per snake, ring from the head
+
+    // per-tick scratch, per snake
+    int *next;                // cell the head moves to, -1 off the board
+    int *blocked;             // next cell is a wall, a body or off the board
+
+    // per cell
+    int *claim;               // head-on resolution, all zero between ticks
+    int *headAt;              // index + 1 of the snake whose head is on the cell, else 0
+    int *fruitSlot;           // slot of the fruit on a LAYER_FRUIT cell
+    int *fruit;               // fruit cells by slot
+} Arena;
+
+int arena_init(Arena *a, int width, int height, int snakes, int fruits, uint64_t seed, int layout);
+void arena_step(Arena *a, const signed char *actions);
+int arena_ai(const Arena *a, int i);
+void arena_free(Arena *a);
+
+static inline int arena_alive(const Arena *a, int i) { return a->respawn[i] == 0; }
+
+// i-th segment of snake s counted from the head (0 = head), as a cell index
+static inline int arena_segment(const Arena *a, int s, int i) {
+    int k = a->ring[s] + i;
+    if (k >= ARENA_MAX_LEN) k -= ARENA_MAX_LEN;
+    return a->body[s * ARENA_MAX_LEN + k];
+}
+
+#endif
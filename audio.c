@@ -0,0 +1,68 @@
+#include "audio.h"
+#include "profile.h"
+#include <string.h>
+
+static const struct { const char *path; float volume; } sfx[SFX_COUNT] = {
+    { "sounds/eat.wav",   0.7f },
+    { "sounds/hit.wav",   1.0f },
+    { "sounds/bonus.wav", 0.6f },
+};
+
+// device init and WAV decoding: the slow part, run on the worker
+static void *load_worker(void *arg) {
+    Audio *a = arg;
+    InitAudioDevice();
+    int device = IsAudioDeviceReady();
+    for (int i = 0; device && i < SFX_COUNT; i++) {
+        if (!FileExists(sfx[i].path)) continue; // skip raylib's failed-open path
+        a->waves[i] = LoadWave(sfx[i].path);
+        a->loaded[i] = a->waves[i].data != NULL;
+    }
+    pthread_mutex_lock(&a->lock);
+    a->device = device;
+    a->done = 1;
+    pthread_mutex_unlock(&a->lock);
+    return NULL;
+}
+
+void audio_start(Audio *a) {
+    memset(a, 0, sizeof(*a));
+    pthread_mutex_init(&a->lock, NULL);
+    a->threaded = pthread_create(&a->thread, NULL, load_worker, a) == 0;
+    if (!a->threaded) load_worker(a); // no thread: load in place, as before
+}
+
+// Call once per frame. Attaches the sounds when the worker has finished;
+// returns 1 on the frame that happens.
+int audio_poll(Audio *a) {
+    if (a->attached) return 0;
+    pthread_mutex_lock(&a->lock);
+    int done = a->done;
+    pthread_mutex_unlock(&a->lock);
+    if (!done) return 0;
+
+    for (int i = 0; i < SFX_COUNT; i++) {
+        if (!a->loaded[i]) continue;
+        a->sounds[i] = LoadSoundFromWave(a->waves[i]);
+        UnloadWave(a->waves[i]);
+        SetSoundVolume(a->sounds[i], sfx[i].volume);
+    }
+    a->attached = 1;
+    PROF_MILESTONE(PROF_AUDIO_READY);
+    return 1;
+}
+
+void audio_play(const Audio *a, int s) {
+    if (a->attached && a->loaded[s]) PlaySound(a->sounds[s]);
+}
+
+void audio_close(Audio *a) {
+    if (a->threaded) pthread_join(a->thread, NULL);
+    for (int i = 0; i < SFX_COUNT; i++) {
+        if (!a->loaded[i]) continue;
+        if (a->attached) UnloadSound(a->sounds[i]);
+        else UnloadWave(a->waves[i]);
+    }
+    if (a->device) CloseAudioDevice();
+    pthread_mutex_destroy(&a->lock);
+}
@@ -0,0 +1,30 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include "raylib.h"
+#include <pthread.h>
+
+// Sound effects, kept off the startup path: a worker thread opens the audio
+// device and decodes the WAVs while the first frames are already drawing, and
+// the main thread turns them into sounds once they are ready. Until then (or
+// if the device or a file is missing) playing one is a no-op.
+enum { SFX_EAT = 0, SFX_HIT, SFX_BONUS, SFX_COUNT };
+
+typedef struct Audio {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    int threaded;             // worker launched; joined on close
+    int done;                 // worker finished (under lock)
+    int attached;             // sounds created on the main thread
+    int device;               // audio device opened
+    Wave waves[SFX_COUNT];    // decoded by the worker, released once attached
+    Sound sounds[SFX_COUNT];
+    int loaded[SFX_COUNT];
+} Audio;
+
+void audio_start(Audio *a);
+int audio_poll(Audio *a);
+void audio_play(const Audio *a, int sfx);
+void audio_close(Audio *a);
+
+#endif
@@ -0,0 +1,361 @@
+// Microbenchmarks for the hot paths: snake movement and collision, occupancy
+// rebuild, free-cell placement, pathfinding, game snapshots, arena ticks and
+// leaderboard loading.
+//   snake_bench [-json] [-filter substring] [-max leaderboardLines]
+// Each benchmark is timed in samples of a calibrated batch of operations on a
+// monotonic clock and reported as ns/op (mean and percentiles over samples)
+// and heap allocations per op. -json prints one JSON object per line.
+#include "game.h"
+#include "ai.h"
+#include "arena.h"
+#include "leaderboard.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SAMPLES 200
+#define SAMPLE_NS 20000.0        // batch size is grown until a sample takes this long
+
+// -------------------- allocation counting --------------------
+// linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc (see the Makefile)
+static long long allocCount;
+void *__real_malloc(size_t n);
+void *__real_calloc(size_t n, size_t m);
+void *__real_realloc(void *p, size_t n);
+void *__wrap_malloc(size_t n) { allocCount++; return __real_malloc(n); }
+void *__wrap_calloc(size_t n, size_t m) { allocCount++; return __real_calloc(n, m); }
+void *__wrap_realloc(void *p, size_t n) { allocCount++; return __real_realloc(p, n); }
+
+// -------------------- harness --------------------
+typedef struct {
+    const char *name;
+    char param[32];
+    int batch;                   // ops per sample
+    int samples, count;
+    double ns[SAMPLES];          // ns/op per sample
+    long long ops, allocs;
+    double t0;
+    long long a0;
+} Bench;
+
+static int jsonOutput;
+static const char *filter;
+static volatile long long sink;  // keeps results alive
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int bench_begin(Bench *b, const char *name, const char *param, int samples, int batch) {
+    if (filter && !strstr(name, filter)) return 0;
+    memset(b, 0, sizeof(*b));
+    b->name = name;
+    snprintf(b->param, sizeof(b->param), "%s", param);
+    b->samples = samples > SAMPLES ? SAMPLES : samples;
+    b->batch = batch;
+    return 1;
+}
+
+static void bench_start(Bench *b) { b->a0 = allocCount; b->t0 = now_ns(); }
+
+static void bench_stop(Bench *b) {
+    double t = now_ns() - b->t0;
+    b->allocs += allocCount - b->a0;
+    b->ops += b->batch;
+    b->ns[b->count++] = t / b->batch;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_report(Bench *b) {
+    double mean = 0;
+    for (int i = 0; i < b->count; i++) mean += b->ns[i];
+    mean /= b->count;
+    qsort(b->ns, b->count, sizeof(double), cmp_double);
+#define PCT(p) b->ns[(int)((b->count - 1) * (p) / 100.0)]
+    double allocsOp = (double)b->allocs / b->ops;
+    if (jsonOutput)
+        printf("{\"bench\":\"%s\",\"param\":\"%s\",\"ops\":%lld,\"ns_op\":%.1f,\"min\":%.1f,\"p50\":%.1f,"
+               "\"p90\":%.1f,\"p99\":%.1f,\"max\":%.1f,\"allocs_op\":%.3f}\n",
+               b->name, b->param, b->ops, mean, b->ns[0], PCT(50), PCT(90), PCT(99), b->ns[b->count - 1], allocsOp);
+    else
+        printf("%-22s %-14s %14.1f %14.1f %14.1f %14.1f %8.3f\n",
+               b->name, b->param, mean, PCT(50), PCT(90), PCT(99), allocsOp);
+#undef PCT
+    fflush(stdout);
+}
+
+// Run `op` in samples of a batch grown until a sample takes SAMPLE_NS.
+#define BENCH_LOOP(b, op) do { \
+    for (;;) { \
+        double t = now_ns(); \
+        for (int k_ = 0; k_ < (b)->batch; k_++) { op; } \
+        if (now_ns() - t >= SAMPLE_NS || (b)->batch >= (1 << 24)) break; \
+        (b)->batch *= 2; \
+    } \
+    for (int s_ = 0; s_ < (b)->samples; s_++) { \
+        bench_start(b); \
+        for (int k_ = 0; k_ < (b)->batch; k_++) { op; } \
+        bench_stop(b); \
+    } \
+    bench_report(b); \
+} while (0)
+
+// -------------------- snake --------------------
+// Hamiltonian cycle on an even-sided board: along row 0, serpentine through
+// columns 1.. of the remaining rows, then back up column 0. A snake steered
+// along it never collides, whatever its length.
+static unsigned char *cycle_dirs(int w, int h) {
+    unsigned char *dir = malloc((size_t)w * h);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int d;
+            if (y == 0) d = x == w - 1 ? 2 : 1;
+            else if (x == 0) d = 0;
+            else if (y % 2 == 1) d = x == 1 ? (y == h - 1 ? 3 : 2) : 3;
+            else d = x == w - 1 ? 2 : 1;
+            if (x == 1 && y == h - 1) d = 3;
+            dir[y * w + x] = (unsigned char)d;
+        }
+    }
+    return dir;
+}
+
+// smallest even square board with room for a snake of `len`
+static int side_for(int len) {
+    int s = 8;
+    while (s * s < 2 * len) s += 2;
+    return s;
+}
+
+static Snake *grow_snake(Board *board, const unsigned char *dir, int len) {
+    Snake *s = create_snake(0, 0, board);
+    while (s->length < len) {
+        s->direction = dir[snake_head_y(s) * board->width + snake_head_x(s)];
+        move_snake(s, 1);
+    }
+    return s;
+}
+
+static void bench_snake(void) {
+    static const int lengths[] = { 10, 100, 1000, 10000, 100000 };
+    for (int li = 0; li < 5; li++) {
+        int len = lengths[li], side = side_for(len);
+        char param[32]; snprintf(param, sizeof(param), "len=%d", len);
+        Board board;
+        if (!board_init(&board, side, side)) continue;
+        unsigned char *dir = cycle_dirs(side, side);
+        Snake *s = grow_snake(&board, dir, len);
+        Bench b;
+
+        if (bench_begin(&b, "move_snake", param, SAMPLES, 1))
+            BENCH_LOOP(&b, {
+                s->direction = dir[snake_head_y(s) * side + snake_head_x(s)];
+                move_snake(s, 0);
+            });
+        if (bench_begin(&b, "check_collision", param, SAMPLES, 1))
+            BENCH_LOOP(&b, sink += check_collision(s, side, side));
+        if (bench_begin(&b, "rebuild_occupancy", param, SAMPLES, 1))
+            BENCH_LOOP(&b, {
+                board_clear_layer(&board, LAYER_SNAKE);
+                SNAKE_FOR_EACH(s, c, board_set(&board, LAYER_SNAKE, CELL_X(c), CELL_Y(c)));
+            });
+
+        free_snake(s); free(dir); board_free(&board);
+    }
+}
+
+// -------------------- placement --------------------
+static void bench_placement(void) {
+    static const int fills[] = { 10, 50, 90, 99 };
+    for (int fi = 0; fi < 4; fi++) {
+        char param[32]; snprintf(param, sizeof(param), "fill=%d%%", fills[fi]);
+        Board board;
+        if (!board_init(&board, GRID_WIDTH, GRID_HEIGHT)) continue;
+        Rng rng; rng_seed(&rng, 1);
+        int cells = GRID_WIDTH * GRID_HEIGHT, x, y;
+        while (board.freeCount > cells - cells * fills[fi] / 100 &&
+               board_random_free(&board, &rng, -1, -1, -1, -1, &x, &y))
+            board_set(&board, LAYER_WALL, x, y);
+        Bench b;
+
+        if (bench_begin(&b, "random_free_cell", param, SAMPLES, 1))
+            BENCH_LOOP(&b, { board_random_free(&board, &rng, -1, -1, -1, -1, &x, &y); sink += x + y; });
+
+        // move the food to a new free cell that avoids two other fruits, as game_step does
+        int fx, fy, ax, ay, bx, by;
+        board_random_free(&board, &rng, -1, -1, -1, -1, &fx, &fy); board_set(&board, LAYER_FRUIT, fx, fy);
+        board_random_free(&board, &rng, -1, -1, -1, -1, &ax, &ay); board_set(&board, LAYER_FRUIT, ax, ay);
+        board_random_free(&board, &rng, -1, -1, -1, -1, &bx, &by); board_set(&board, LAYER_FRUIT, bx, by);
+        if (bench_begin(&b, "place_food", param, SAMPLES, 1))
+            BENCH_LOOP(&b, {
+                if (board_random_free(&board, &rng, ax, ay, bx, by, &x, &y)) {
+                    board_clear(&board, LAYER_FRUIT, fx, fy);
+                    board_set(&board, LAYER_FRUIT, x, y);
+                    fx = x; fy = y;
+                }
+            });
+        board_free(&board);
+    }
+}
+
+// -------------------- pathfinding --------------------
+// AI decisions timed one at a time while the game plays on between them
+static void bench_path(void) {
+    static const struct { int difficulty, width, height, layout; const char *param; } cases[] = {
+        { 1, GRID_WIDTH, GRID_HEIGHT, LAYOUT_DEFAULT, "no walls" },
+        { 3, GRID_WIDTH, GRID_HEIGHT, LAYOUT_DEFAULT, "walls" },
+        { 1, 256, 256, LAYOUT_DEFAULT, "no walls 256" },
+        { 3, 256, 256, LAYOUT_DEFAULT, "walls 256" },
+        { 1, 256, 256, LAYOUT_MAZE, "maze 256" },
+    };
+    for (int ci = 0; ci < 5; ci++) {
+        Bench b;
+        if (!bench_begin(&b, "find_path_to_target", cases[ci].param, SAMPLES, 64)) continue;
+        GameState g;
+        PathFinder pf;
+        if (!game_init_layout(&g, cases[ci].width, cases[ci].height, 1, cases[ci].difficulty, cases[ci].layout)) continue;
+        if (!path_init(&pf, g.board.width, g.board.height)) { game_free(&g); continue; }
+        uint64_t seed = 1;
+        for (int s = 0; s < b.samples; s++) {
+            double t = 0;
+            long long a = 0;
+            for (int k = 0; k < b.batch; k++) {
+                if (g.gameOver) game_reseed(&g, ++seed);
+                bench_start(&b);
+                int dir;
+                int ok = find_path_to_target(&pf, &g.board, &g.snake, g.grow, (g.lastMoveDir + 2) % 4,
+                                             g.food.x, g.food.y, &dir);
+                t += now_ns() - b.t0;
+                a += allocCount - b.a0;
+                game_step(&g, ok ? dir : ACTION_NONE);
+            }
+            b.ns[b.count++] = t / b.batch;
+            b.ops += b.batch; b.allocs += a;
+        }
+        bench_report(&b);
+        path_free(&pf); game_free(&g);
+    }
+}
+
+// -------------------- snapshots --------------------
+// forking a mid-game state into a reused clone and restoring a snapshot, as a
+// lookahead search does for every candidate future
+static void bench_snapshot(void) {
+    static const struct { int width, height; const char *param; } cases[] = {
+        { GRID_WIDTH, GRID_HEIGHT, "30x20" },
+        { 256, 256, "256x256" },
+    };
+    for (int ci = 0; ci < 2; ci++) {
+        GameState g, fork;
+        PathFinder pf;
+        if (!game_init_layout(&g, cases[ci].width, cases[ci].height, 1, 2, LAYOUT_DEFAULT)) continue;
+        if (!path_init(&pf, g.board.width, g.board.height)) { game_free(&g); continue; }
+        for (int t = 0; t < 200 && !g.gameOver; t++) game_step(&g, ai_choose(&pf, &g));
+        memset(&fork, 0, sizeof(fork));
+        void *snap = malloc(game_snapshot_size(&g));
+        if (snap && game_clone(&fork, &g)) {
+            game_snapshot(&g, snap);
+            Bench b;
+            if (bench_begin(&b, "game_clone", cases[ci].param, SAMPLES, 64))
+                BENCH_LOOP(&b, sink += game_clone(&fork, &g));
+            if (bench_begin(&b, "game_restore", cases[ci].param, SAMPLES, 64))
+                BENCH_LOOP(&b, sink += game_restore(&fork, snap));
+        }
+        free(snap); game_free(&fork); path_free(&pf); game_free(&g);
+    }
+}
+
+// -------------------- leaderboard --------------------
+#define BENCH_TEXT "bench_leaderboard.txt"
+#define BENCH_LOG "bench_leaderboard.dat"
+
+// old-format text file with `lines` entries from distinct players, imported into a binary log
+static int make_leaderboard(long lines) {
+    remove(BENCH_LOG);
+    FILE *f = fopen(BENCH_TEXT, "w");
+    if (!f) return 0;
+    Rng rng; rng_seed(&rng, (uint64_t)lines);
+    for (long i = 0; i < lines; i++) fprintf(f, "p%ld %u\n", i, rng_below(&rng, 100000));
+    fclose(f);
+    Leaderboard lb;
+    leaderboard_load(&lb, BENCH_LOG, BENCH_TEXT);
+    leaderboard_free(&lb);
+    remove(BENCH_TEXT);
+    return 1;
+}
+
+static void bench_leaderboard(long maxLines) {
+    for (long lines = 10; lines <= maxLines; lines *= 10) {
+        char param[32]; snprintf(param, sizeof(param), "lines=%ld", lines);
+        if (filter && !strstr("leaderboard_load leaderboard_top10", filter)) return;
+        if (!make_leaderboard(lines)) return;
+        // fewer samples for big files; each load is one op
+        int samples = (int)(2000000 / lines);
+        if (samples < 3) samples = 3;
+        Bench b;
+        Leaderboard lb;
+
+        if (bench_begin(&b, "leaderboard_load", param, samples, 1)) {
+            for (int s = 0; s < b.samples; s++) {
+                bench_start(&b);
+                leaderboard_load(&lb, BENCH_LOG, NULL);
+                bench_stop(&b);
+                leaderboard_free(&lb);
+            }
+            bench_report(&b);
+        }
+
+        leaderboard_load(&lb, BENCH_LOG, NULL);
+        PlayerScore top[LEADERBOARD_TOP];
+        if (bench_begin(&b, "leaderboard_top10", param, SAMPLES, 1))
+            BENCH_LOOP(&b, sink += scoreindex_top(&lb.index, top, LEADERBOARD_TOP));
+        leaderboard_free(&lb);
+        remove(BENCH_LOG);
+    }
+}
+
+// -------------------- arena --------------------
+// one whole tick of the arena with the built-in AI, at a density of one snake
+// per 256 cells; the arena is warmed up first so respawns are in steady state
+static void bench_arena(void) {
+    static const int counts[] = { 64, 1024, 16384 };
+    for (int ci = 0; ci < 3; ci++) {
+        int n = counts[ci], side = 16;
+        while (side * side < n * 256) side *= 2;
+        char param[32]; snprintf(param, sizeof(param), "snakes=%d", n);
+        Bench b;
+        if (!bench_begin(&b, "arena_step", param, 50, 1)) continue;
+        Arena a;
+        if (!arena_init(&a, side, side, n, 0, 1, LAYOUT_OPEN)) continue;
+        for (int t = 0; t < 200; t++) arena_step(&a, NULL);
+        BENCH_LOOP(&b, arena_step(&a, NULL));
+        arena_free(&a);
+    }
+}
+
+int main(int argc, char **argv) {
+    long maxLines = 1000000; // -max 10000000 for the full range (~0.5 GB log)
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-json")) jsonOutput = 1;
+        else if (!strcmp(argv[i], "-filter") && i + 1 < argc) filter = argv[++i];
+        else if (!strcmp(argv[i], "-max") && i + 1 < argc) maxLines = atol(argv[++i]);
+        else { fprintf(stderr, "usage: %s [-json] [-filter substring] [-max leaderboardLines]\n", argv[0]); return 2; }
+    }
+    if (!jsonOutput)
+        printf("%-22s %-14s %14s %14s %14s %14s %8s\n", "benchmark", "param", "ns/op", "p50", "p90", "p99", "allocs");
+
+    bench_snake();
+    bench_placement();
+    bench_path();
+    bench_snapshot();
+    bench_arena();
+    bench_leaderboard(maxLines);
+    return 0;
+}
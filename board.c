@@ -0,0 +1,100 @@
+#include "board.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Bytes a board's layers and free-cell set take: the bits first (8-byte
+// aligned at the start), then freeCells and freeIndex
+size_t board_bytes(int width, int height) {
+    int cells = width * height;
+    return sizeof(uint64_t) * (size_t)((cells + 63) / 64) * LAYER_COUNT + sizeof(int) * (size_t)cells * 2;
+}
+
+// point the board at board_bytes() of caller-owned memory (width/height already set)
+void board_attach(Board *b, void *mem) {
+    int cells = b->width * b->height;
+    uint64_t *bits = mem;
+    b->words = (cells + 63) / 64;
+    for (int l = 0; l < LAYER_COUNT; l++) b->layer[l] = bits + (size_t)l * b->words;
+    b->freeCells = (int *)(bits + (size_t)b->words * LAYER_COUNT);
+    b->freeIndex = b->freeCells + cells;
+}
+
+int board_init(Board *b, int width, int height) {
+    b->width = width;
+    b->height = height;
+    // layers and free set share one allocation
+    void *mem = malloc(board_bytes(width, height));
+    if (!mem) return 0;
+    memset(b->version, 0, sizeof(b->version));
+    board_attach(b, mem);
+    board_reset(b);
+    return 1;
+}
+
+// empty every layer and put the free-cell set back in canonical order, so
+// random draws after a reset depend only on the RNG, not on earlier games
+void board_reset(Board *b) {
+    int cells = b->width * b->height;
+    memset(b->layer[0], 0, sizeof(uint64_t) * b->words * LAYER_COUNT);
+    for (int i = 0; i < cells; i++) { b->freeCells[i] = i; b->freeIndex[i] = i; }
+    b->freeCount = cells;
+    for (int l = 0; l < LAYER_COUNT; l++) b->version[l]++;
+}
+
+// only for boards from board_init; attached boards belong to whoever owns the memory
+void board_free(Board *b) {
+    free(b->layer[0]);
+    for (int l = 0; l < LAYER_COUNT; l++) b->layer[l] = NULL;
+    b->freeCells = b->freeIndex = NULL;
+    b->freeCount = 0;
+}
+
+// clears only the bits that are set, so cost follows the layer's population
+void board_clear_layer(Board *b, int layer) {
+    uint64_t *bits = b->layer[layer];
+    b->version[layer]++;
+    for (int w = 0; w < b->words; w++) {
+        uint64_t word = bits[w];
+        bits[w] = 0;
+        while (word) {
+            unsigned i = (unsigned)w * 64 + (unsigned)__builtin_ctzll(word);
+            word &= word - 1;
+            if (board_cell_empty(b, i)) board_free_add(b, i);
+        }
+    }
+}
+
+int board_equal(const Board *a, const Board *b) {
+    if (a->width != b->width || a->height != b->height) return 0;
+    return memcmp(a->layer[0], b->layer[0], sizeof(uint64_t) * a->words * LAYER_COUNT) == 0;
+}
+
+// free-cell set must hold exactly the cells that are empty on every layer
+int board_check_free(const Board *b) {
+    int cells = b->width * b->height, empty = 0;
+    for (int i = 0; i < cells; i++) {
+        int slot = b->freeIndex[i];
+        if (board_cell_empty(b, (unsigned)i)) {
+            empty++;
+            if (slot < 0 || slot >= b->freeCount || b->freeCells[slot] != i) return 0;
+        } else if (slot != -1) return 0;
+    }
+    return empty == b->freeCount;
+}
+
+// Uniform draw over free cells minus the (up to two) avoid cells, by rejection.
+// Returns 0 when nothing is left to pick.
+int board_random_free(const Board *b, Rng *rng, int avoidX1, int avoidY1, int avoidX2, int avoidY2,
+                      int *outX, int *outY) {
+    int a1 = board_in_bounds(b, avoidX1, avoidY1) ? avoidY1 * b->width + avoidX1 : -1;
+    int a2 = board_in_bounds(b, avoidX2, avoidY2) ? avoidY2 * b->width + avoidX2 : -1;
+    if (a2 == a1) a2 = -1;
+    int blocked = (a1 >= 0 && b->freeIndex[a1] >= 0) + (a2 >= 0 && b->freeIndex[a2] >= 0);
+    if (b->freeCount - blocked <= 0) return 0;
+    for (;;) {
+        int i = b->freeCells[rng_below(rng, b->freeCount)];
+        if (i == a1 || i == a2) continue;
+        *outX = i % b->width; *outY = i / b->width;
+        return 1;
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rng.h"
+
+// Occupancy layers kept on the board
+enum { LAYER_SNAKE = 0, LAYER_WALL, LAYER_FRUIT, LAYER_COUNT };
+
+// Bit-packed occupancy board: one bit per cell per layer, row-major.
+// Updated in place as things move, so lookups are a single bit test.
+// Cells empty on every layer are also kept in a dense free-cell set
+// (swap-remove array + position map) so a uniform free cell is an O(1) draw.
+typedef struct Board {
+    int width, height;
+    int words;                      // 64-bit words per layer
+    uint64_t *layer[LAYER_COUNT];
+    int *freeCells;                 // dense list of empty cell indices
+    int *freeIndex;                 // cell index -> slot in freeCells, -1 if occupied
+    int freeCount;
+    unsigned version[LAYER_COUNT];  // bumped on every change, lets callers cache per-layout data
+} Board;
+
+int board_init(Board *b, int width, int height);
+size_t board_bytes(int width, int height);
+void board_attach(Board *b, void *mem);
+void board_free(Board *b);
+void board_reset(Board *b);
+void board_clear_layer(Board *b, int layer);
+int board_equal(const Board *a, const Board *b);
+int board_check_free(const Board *b);
+int board_random_free(const Board *b, Rng *rng, int avoidX1, int avoidY1, int avoidX2, int avoidY2,
+                      int *outX, int *outY);
+
+static inline int board_cell_empty(const Board *b, unsigned i) {
+    uint64_t any = 0;
+    for (int l = 0; l < LAYER_COUNT; l++) any |= b->layer[l][i >> 6];
+    return !((any >> (i & 63)) & 1u);
+}
+
+static inline void board_free_remove(Board *b, unsigned i) {
+    int slot = b->freeIndex[i], last = b->freeCells[--b->freeCount];
+    b->freeCells[slot] = last; b->freeIndex[last] = slot;
+    b->freeIndex[i] = -1;
+}
+
+static inline void board_free_add(Board *b, unsigned i) {
+    b->freeIndex[i] = b->freeCount;
+    b->freeCells[b->freeCount++] = (int)i;
+}
+
+static inline int board_in_bounds(const Board *b, int x, int y) {
+    return x >= 0 && x < b->width && y >= 0 && y < b->height;
+}
+
+// out-of-bounds cells read as empty and ignore writes
+static inline int board_test(const Board *b, int layer, int x, int y) {
+    if (!board_in_bounds(b, x, y)) return 0;
+    unsigned i = (unsigned)(y * b->width + x);
+    return (int)((b->layer[layer][i >> 6] >> (i & 63)) & 1u);
+}
+
+static inline void board_set(Board *b, int layer, int x, int y) {
+    if (!board_in_bounds(b, x, y)) return;
+    unsigned i = (unsigned)(y * b->width + x);
+    if (board_cell_empty(b, i)) board_free_remove(b, i);
+    b->layer[layer][i >> 6] |= (uint64_t)1 << (i & 63);
+    b->version[layer]++;
+}
+
+static inline void board_clear(Board *b, int layer, int x, int y) {
+    if (!board_in_bounds(b, x, y)) return;
+    unsigned i = (unsigned)(y * b->width + x);
+    if (!((b->layer[layer][i >> 6] >> (i & 63)) & 1u)) return;
+    b->layer[layer][i >> 6] &= ~((uint64_t)1 << (i & 63));
+    b->version[layer]++;
+    if (board_cell_empty(b, i)) board_free_add(b, i);
+}
+
+#endif
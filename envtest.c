@@ -0,0 +1,128 @@
+// Vectorized environment checks: stepping allocates nothing, rewards add up
+// to each finished game's score, observations agree with the positions
+// reported beside them, and a seed replays exactly.
+//   snake_envtest
+// Prints one line per failed check and exits non-zero if there were any.
+#include "vecenv.h"
+#include "game.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GAMES 64
+#define STEPS 20000
+#define WARMUP 100   // debug builds size each game's occupancy check board on its first move
+
+// -------------------- allocation counting --------------------
+// linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc (see the Makefile)
+static long long allocCount;
+void *__real_malloc(size_t n);
+void *__real_calloc(size_t n, size_t m);
+void *__real_realloc(void *p, size_t n);
+void *__wrap_malloc(size_t n) { allocCount++; return __real_malloc(n); }
+void *__wrap_calloc(size_t n, size_t m) { allocCount++; return __real_calloc(n, m); }
+void *__wrap_realloc(void *p, size_t n) { allocCount++; return __real_realloc(p, n); }
+
+static int failures;
+
+#define CHECK(cond) do { if (!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++; } } while (0)
+
+typedef struct {
+    uint8_t grid[GAMES * GRID_WIDTH * GRID_HEIGHT];
+    int32_t pos[GAMES * VEC_POS];
+    float reward[GAMES];
+    uint8_t done[GAMES];
+} Buffers;
+
+static uint64_t lcg(uint64_t *s) {
+    *s = *s * 6364136223846793005ull + 1442695040888963407ull;
+    return *s >> 33;
+}
+
+// the head and every fruit reported in pos[] carry their codes in the grid
+// (a fruit is drawn over the head: a snake can respawn onto one)
+static int observation_consistent(const Buffers *b, int i) {
+    const uint8_t *grid = b->grid + (size_t)i * GRID_WIDTH * GRID_HEIGHT;
+    const int32_t *pos = b->pos + (size_t)i * VEC_POS;
+    static const int codes[4] = { VEC_CELL_HEAD, VEC_CELL_FOOD, VEC_CELL_BONUS, VEC_CELL_POWER };
+    for (int k = 0; k < 4; k++) {
+        int x = pos[2 * k], y = pos[2 * k + 1];
+        if (x < 0) { if (k == 0) return 0; continue; }
+        if (x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT) return 0;
+        int covered = 0;
+        for (int f = 1; k == 0 && f < 4; f++) covered |= pos[2 * f] == x && pos[2 * f + 1] == y;
+        if (!covered && grid[y * GRID_WIDTH + x] != codes[k]) return 0;
+    }
+    return 1;
+}
+
+// random moves die often, so the reset path is exercised as much as stepping
+static void test_layout(int layout) {
+    static Buffers b;
+    VecEnv *env = vec_env_create(GAMES, GRID_WIDTH, GRID_HEIGHT, 2, layout, 1, 0);
+    CHECK(env != NULL);
+    if (!env) return;
+    vec_env_set_buffers(env, b.grid, b.pos, b.reward, b.done);
+    CHECK(vec_env_reset(env));
+
+    int32_t actions[GAMES];
+    double earned[GAMES] = {0};
+    long episodes = 0, mismatched = 0, inconsistent = 0;
+    uint64_t rng = 42;
+    long long allocs = 0;
+    for (int t = 0; t < STEPS; t++) {
+        if (t == WARMUP) allocs = allocCount;
+        for (int i = 0; i < GAMES; i++) actions[i] = (int32_t)(lcg(&rng) % 5) - 1;
+        vec_env_step(env, actions);
+        for (int i = 0; i < GAMES; i++) {
+            earned[i] += b.reward[i];
+            if (b.done[i]) {
+                episodes++;
+                mismatched += earned[i] != vec_env_score(env, i);
+                earned[i] = 0;
+            }
+            inconsistent += !observation_consistent(&b, i);
+        }
+    }
+    CHECK(allocCount == allocs);
+    CHECK(episodes > 0);
+    CHECK(mismatched == 0);
+    CHECK(inconsistent == 0);
+    vec_env_free(env);
+}
+
+// two environments on the same seed and actions write identical buffers
+static void test_deterministic(void) {
+    static Buffers a, b;
+    VecEnv *ea = vec_env_create(GAMES, GRID_WIDTH, GRID_HEIGHT, 3, LAYOUT_SCATTER, 7, 500);
+    VecEnv *eb = vec_env_create(GAMES, GRID_WIDTH, GRID_HEIGHT, 3, LAYOUT_SCATTER, 7, 500);
+    CHECK(ea && eb);
+    if (ea && eb) {
+        vec_env_set_buffers(ea, a.grid, a.pos, a.reward, a.done);
+        vec_env_set_buffers(eb, b.grid, b.pos, b.reward, b.done);
+        vec_env_reset(ea);
+        vec_env_reset(eb);
+        int32_t actions[GAMES];
+        uint64_t rng = 9;
+        int same = 1;
+        for (int t = 0; t < 2000 && same; t++) {
+            for (int i = 0; i < GAMES; i++) actions[i] = (int32_t)(lcg(&rng) % 5) - 1;
+            vec_env_step(ea, actions);
+            vec_env_step(eb, actions);
+            same = !memcmp(&a, &b, sizeof(a));
+        }
+        CHECK(same);
+    }
+    vec_env_free(ea);
+    vec_env_free(eb);
+}
+
+int main(void) {
+    test_layout(LAYOUT_OPEN);
+    test_layout(LAYOUT_SCATTER);
+    test_layout(LAYOUT_MAZE);
+    test_deterministic();
+    if (failures) { printf("%d check(s) failed\n", failures); return 1; }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,358 @@
+#include "game.h"
+#include "profile.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+const PowerUpDef powerUps[POWERUPS] = {
+    //                 name     every lifetime points effect       seconds  spawn event
+    [POWERUP_BONUS] = { "BONUS",  8,  5.0,     20,    EFFECT_NONE, 0.0,     EV_BONUS_SPAWN },
+    [POWERUP_SLOW]  = { "POWER", 12,  7.0,     15,    EFFECT_SLOW, 5.0,     0 },
+};
+
+_Static_assert(POWERUPS + EFFECTS <= TIMER_MAX, "timer wheel too small for every power-up and effect");
+
+// per difficulty: ticks/sec, score multiplier, lives, scattered walls
+static const int difficultyTable[3][4] = {
+    {  8, 1, 3, 0             },  // Easy: no obstacles
+    { 12, 2, 5, SCATTER_WALLS },  // Medium
+    { 18, 3, 8, SCATTER_WALLS },  // Hard
+};
+
+// fruit cells are marked on LAYER_FRUIT while they are on the board
+static void put_fruit(GameState *g, Fruit *f, int x, int y) {
+    f->x = x; f->y = y; f->active = 1;
+    board_set(&g->board, LAYER_FRUIT, x, y);
+}
+static void take_fruit(GameState *g, Fruit *f) {
+    f->active = 0;
+    board_clear(&g->board, LAYER_FRUIT, f->x, f->y);
+}
+
+// the snake lives in the game's block and is reset in place on every respawn
+static void respawn_snake(GameState *g) {
+    reset_snake(&g->snake, g->board.width/2, g->board.height/2);
+    g->lastMoveDir = g->snake.direction;
+}
+
+// ---- memory block ----
+
+static size_t align8(size_t n) { return (n + 7) & ~(size_t)7; }
+
+// snake ring, then the board's bits and free set, then the wall list
+static size_t block_bytes(int width, int height) {
+    size_t cells = (size_t)width * height;
+    return align8(sizeof(Cell) * (cells + 1)) + board_bytes(width, height) + sizeof(Cell) * cells;
+}
+
+// aim every pointer of the state into its own block (after an allocation or a copy)
+static void attach(GameState *g) {
+    int w = g->board.width, h = g->board.height;
+    unsigned char *p = g->mem;
+    g->snake.body = (Cell *)p;
+    g->snake.board = &g->board;
+    p += align8(sizeof(Cell) * ((size_t)w * h + 1));
+    board_attach(&g->board, p);
+    p += board_bytes(w, h);
+    g->walls = (Cell *)p;
+}
+
+// (re)size the block for a w x h board; the contents are undefined
+static int alloc_block(GameState *g, int width, int height) {
+    size_t bytes = block_bytes(width, height);
+    if (g->mem && g->memSize == bytes && g->board.width == width && g->board.height == height) return 1;
+    free(g->mem);
+    g->mem = malloc(bytes);
+    g->memSize = g->mem ? bytes : 0;
+    if (!g->mem) return 0;
+    g->board.width = width; g->board.height = height;
+    attach(g);
+    return 1;
+}
+
+#ifndef NDEBUG
+// Debug builds: compare the incrementally maintained board against a full rebuild
+// into a scratch board kept for the whole game
+static void check_occupancy(GameState *g) {
+    Board *ref = &g->checkBoard;
+    if (ref->width) board_reset(ref);
+    else if (!board_init(ref, g->board.width, g->board.height)) return;
+    SNAKE_FOR_EACH(&g->snake, c, board_set(ref, LAYER_SNAKE, CELL_X(c), CELL_Y(c)));
+    for (int i = 0; i < g->wallCount; i++) board_set(ref, LAYER_WALL, CELL_X(g->walls[i]), CELL_Y(g->walls[i]));
+    if (g->food.active) board_set(ref, LAYER_FRUIT, g->food.x, g->food.y);
+    for (int i = 0; i < POWERUPS; i++)
+        if (g->powerup[i].active) board_set(ref, LAYER_FRUIT, g->powerup[i].x, g->powerup[i].y);
+    assert(board_equal(ref, &g->board) && "occupancy board out of sync");
+    assert(board_check_free(&g->board) && "free-cell set out of sync");
+}
+#endif
+
+void game_difficulty(int difficulty, int *speed, int *multiplier, int *lives) {
+    const int *d = difficultyTable[(difficulty < 1 || difficulty > 3 ? 1 : difficulty) - 1];
+    *speed = d[0]; *multiplier = d[1]; *lives = d[2];
+}
+
+int game_init(GameState *g, int width, int height, uint64_t seed, int difficulty) {
+    return game_init_layout(g, width, height, seed, difficulty, LAYOUT_DEFAULT);
+}
+
+int game_init_layout(GameState *g, int width, int height, uint64_t seed, int difficulty, int layout) {
+    memset(g, 0, sizeof(*g));
+    if (width < GRID_MIN || height < GRID_MIN || width > GRID_MAX || height > GRID_MAX) return 0;
+    if (!alloc_block(g, width, height)) return 0;
+    board_reset(&g->board);
+    snake_init(&g->snake, g->snake.body, &g->board, width/2, height/2);
+    if (difficulty < 1 || difficulty > 3) difficulty = 1;
+    g->difficulty = difficulty;
+    g->layout = layout >= 0 && layout < LAYOUTS ? layout : LAYOUT_DEFAULT;
+    rng_seed(&g->rng, seed);
+    game_reset(g);
+    return 1;
+}
+
+// refill the packed wall list from the wall layer (only when a level is laid out);
+// the list has room for every cell
+static void collect_walls(GameState *g) {
+    const Board *b = &g->board;
+    g->wallCount = 0;
+    for (int w = 0; w < b->words; w++) {
+        for (uint64_t bits = b->layer[LAYER_WALL][w]; bits; bits &= bits - 1) {
+            int k = w * 64 + __builtin_ctzll(bits);
+            g->walls[g->wallCount++] = CELL_PACK(k % b->width, k / b->width);
+        }
+    }
+}
+
+// start a new round at the same difficulty; the RNG stream carries on
+void game_reset(GameState *g) {
+    const int *d = difficultyTable[g->difficulty - 1];
+    g->speed = d[0]; g->multiplier = d[1]; g->lives = d[2];
+
+    board_reset(&g->board);
+    g->food.active = 0;
+    for (int i = 0; i < POWERUPS; i++) g->powerup[i].active = 0;
+    timer_clear(&g->timers);
+    respawn_snake(g);
+
+    // obstacles: the layout picks them, the level keeps every open cell reachable
+    int layout = g->layout != LAYOUT_DEFAULT ? g->layout : d[3] ? LAYOUT_SCATTER : LAYOUT_OPEN;
+    int walls = (int)((long long)d[3] * g->board.width * g->board.height / (GRID_WIDTH * GRID_HEIGHT));
+    int valid = level_generate(&g->board, &g->rng, layout, walls, g->board.width/2, g->board.height/2,
+                               &g->levelScratch);
+    assert(valid && "generated level is not connected");
+    (void)valid;
+    collect_walls(g);
+
+    // place normal food (avoid clash with snake/walls)
+    int fx, fy;
+    if (board_random_free(&g->board, &g->rng, -1, -1, -1, -1, &fx, &fy)) put_fruit(g, &g->food, fx, fy);
+
+    g->fruitsEaten = 0;
+    g->slowMode = 0;
+    g->score = 0;
+    g->grow = 0;
+    g->gameOver = 0;
+    g->lastDeath = DEATH_NONE;
+    g->tick = 0;
+}
+
+// new game from a fresh seed, reusing the state's memory
+void game_reseed(GameState *g, uint64_t seed) {
+    rng_seed(&g->rng, seed);
+    game_reset(g);
+}
+
+// lose a life and respawn, or end the game on the last one
+static int lose_life(GameState *g, int cause) {
+    g->lastDeath = cause;
+    if (g->lives > 1) {
+        g->lives--;
+        respawn_snake(g);
+        return EV_LIFE_LOST;
+    }
+    g->lives = 0; g->gameOver = 1;
+    return EV_GAME_OVER;
+}
+
+// ---- power-ups and timed effects ----
+
+static void start_effect(GameState *g, int effect, double seconds) {
+    if (effect == EFFECT_SLOW) {
+        g->slowMode = 1;
+        g->slowEnds = g->tick + game_seconds(g, seconds);
+        timer_set(&g->timers, TIMER_EFFECT(EFFECT_SLOW), g->slowEnds + 1);
+    }
+}
+
+static void end_effect(GameState *g, int effect) {
+    if (effect == EFFECT_SLOW) g->slowMode = 0;
+}
+
+// Spawn rules, after a normal fruit: each power-up that is due and not
+// already out goes on a free cell until its lifetime runs out.
+static int spawn_powerups(GameState *g) {
+    int events = 0;
+    for (int i = 0; i < POWERUPS; i++) {
+        const PowerUpDef *def = &powerUps[i];
+        Fruit *f = &g->powerup[i];
+        if (g->fruitsEaten % def->every != 0 || f->active) continue;
+        events |= def->spawnEvent;
+        int x, y;
+        if (!board_random_free(&g->board, &g->rng, -1, -1, -1, -1, &x, &y)) continue;
+        put_fruit(g, f, x, y);
+        f->expires = g->tick + game_seconds(g, def->lifetime);
+        timer_set(&g->timers, TIMER_EXPIRE(i), f->expires + 1);
+    }
+    return events;
+}
+
+// everything due this tick: uneaten power-ups vanish, effects wear off
+static void fire_timers(GameState *g) {
+    for (int id; (id = timer_pop(&g->timers, g->tick)) >= 0; ) {
+        if (id < POWERUPS) take_fruit(g, &g->powerup[id]);
+        else end_effect(g, id - POWERUPS);
+    }
+}
+
+// Re-arm the wheel from the fruit expiries and effect ends, for a state that
+// was filled in field by field (a loaded save). Anything already overdue
+// fires on the next tick.
+static void arm(GameState *g, int id, int last) {
+    timer_set(&g->timers, id, last >= g->tick ? last + 1 : g->tick + 1);
+}
+
+void game_arm_timers(GameState *g) {
+    timer_clear(&g->timers);
+    for (int i = 0; i < POWERUPS; i++)
+        if (g->powerup[i].active) arm(g, TIMER_EXPIRE(i), g->powerup[i].expires);
+    if (g->slowMode) arm(g, TIMER_EFFECT(EFFECT_SLOW), g->slowEnds);
+}
+
+// Advance one tick. `action` is a direction or ACTION_NONE; reversing into
+// the neck is ignored. Returns a mask of EV_* events.
+int game_step(GameState *g, int action) {
+    if (g->gameOver) return 0;
+    g->tick++;
+    Snake *snake = &g->snake;
+    int events = 0;
+
+    if (action >= 0 && action < 4 && action != (g->lastMoveDir + 2) % 4) snake->direction = action;
+
+    fire_timers(g);
+
+    // slow mode: the snake only advances on every other tick
+    if (g->slowMode && (g->tick & 1)) return events;
+
+    move_snake(snake, g->grow);
+    g->grow = 0;
+    g->lastMoveDir = snake->direction;
+    events |= EV_MOVED;
+    int hx = snake_head_x(snake), hy = snake_head_y(snake);
+
+    // collision with walls (if any): skip other checks this tick
+    if (board_test(&g->board, LAYER_WALL, hx, hy)) return events | lose_life(g, DEATH_WALL);
+
+    // Normal food eaten
+    if (hx == g->food.x && hy == g->food.y) {
+        events |= EV_ATE;
+        g->grow = 1;
+        g->score += FOOD_POINTS * g->multiplier;
+        g->fruitsEaten++;
+
+        // place new normal food; fruit cells are never free, so it can't land on a power-up
+        PROF_BEGIN(PROF_PLACE);
+        int fx, fy;
+        if (board_random_free(&g->board, &g->rng, -1, -1, -1, -1, &fx, &fy)) {
+            take_fruit(g, &g->food); put_fruit(g, &g->food, fx, fy);
+        }
+        events |= spawn_powerups(g);
+        PROF_END(PROF_PLACE);
+    }
+
+    // power-ups: points, growth and their effect
+    for (int i = 0; i < POWERUPS; i++) {
+        Fruit *f = &g->powerup[i];
+        if (!f->active || hx != f->x || hy != f->y) continue;
+        const PowerUpDef *def = &powerUps[i];
+        events |= EV_ATE;
+        g->score += def->points * g->multiplier;
+        g->grow = 1; take_fruit(g, f);
+        timer_cancel(&g->timers, TIMER_EXPIRE(i));
+        start_effect(g, def->effect, def->effectSeconds);
+    }
+
+    // boundary/self collision (self collision -> lose life or game over)
+    if (check_collision(snake, g->board.width, g->board.height))
+        events |= lose_life(g, board_in_bounds(&g->board, hx, hy) ? DEATH_SELF : DEATH_BOUNDARY);
+
+#ifndef NDEBUG
+    PROF_BEGIN(PROF_OCCUPANCY);
+    check_occupancy(g);
+    PROF_END(PROF_OCCUPANCY);
+#endif
+    return events;
+}
+
+void game_free(GameState *g) {
+    if (g->checkBoard.width) board_free(&g->checkBoard);
+    memset(&g->checkBoard, 0, sizeof(g->checkBoard));
+    level_scratch_free(&g->levelScratch);
+    free(g->mem);
+    g->mem = NULL; g->memSize = 0;
+    g->walls = NULL; g->wallCount = 0;
+    g->snake.body = NULL;
+    for (int l = 0; l < LAYER_COUNT; l++) g->board.layer[l] = NULL;
+    g->board.freeCells = g->board.freeIndex = NULL;
+}
+
+// ---- snapshots ----
+
+size_t game_snapshot_size(const GameState *g) {
+    return sizeof(GameState) + g->memSize;
+}
+
+// the struct as is (its pointers are meaningless in the copy), then the block
+void game_snapshot(const GameState *g, void *buf) {
+    memcpy(buf, g, sizeof(GameState));
+    memcpy((unsigned char *)buf + sizeof(GameState), g->mem, g->memSize);
+}
+
+// Overwrite dst with src's state and block, keeping dst's own memory and
+// workspace. Layer versions move past both sides' so caches keyed on them
+// (the board view) see the change.
+static void copy_state(GameState *dst, const GameState *src, const void *block) {
+    unsigned char *mem = dst->mem;
+    Board checkBoard = dst->checkBoard;
+    LevelScratch levelScratch = dst->levelScratch;
+    unsigned version[LAYER_COUNT];
+    for (int l = 0; l < LAYER_COUNT; l++)
+        version[l] = (dst->board.version[l] > src->board.version[l] ? dst->board.version[l] : src->board.version[l]) + 1;
+
+    memcpy(dst, src, sizeof(GameState));
+    dst->mem = mem;
+    dst->checkBoard = checkBoard;
+    dst->levelScratch = levelScratch;
+    memcpy(dst->mem, block, dst->memSize);
+    memcpy(dst->board.version, version, sizeof(version));
+    attach(dst);
+}
+
+// 0 if the snapshot is for a different board size
+int game_restore(GameState *g, const void *buf) {
+    const GameState *s = buf;
+    if (!g->mem || s->board.width != g->board.width || s->board.height != g->board.height ||
+        s->memSize != g->memSize) return 0;
+    copy_state(g, s, (const unsigned char *)buf + sizeof(GameState));
+    return 1;
+}
+
+int game_clone(GameState *dst, const GameState *src) {
+    if (dst->checkBoard.width && (dst->checkBoard.width != src->board.width ||
+                                  dst->checkBoard.height != src->board.height)) {
+        board_free(&dst->checkBoard);
+        memset(&dst->checkBoard, 0, sizeof(dst->checkBoard));
+    }
+    if (!alloc_block(dst, src->board.width, src->board.height)) return 0;
+    copy_state(dst, src, src->mem);
+    return 1;
+}
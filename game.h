@@ -0,0 +1,128 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include "board.h"
+#include "snake.h"
+#include "rng.h"
+#include "level.h"
+#include "timer.h"
+
+// Default board size; any size in [GRID_MIN, GRID_MAX] can be chosen at game_init
+#define GRID_WIDTH 30
+#define GRID_HEIGHT 20
+#define GRID_MIN 4
+#define GRID_MAX 32767  // cells pack each coordinate into 16 bits
+
+// Scattered obstacles on a default-sized board; scaled with the board area
+#define SCATTER_WALLS 8
+
+// Actions: a direction (0=UP, 1=RIGHT, 2=DOWN, 3=LEFT) or keep going
+#define ACTION_NONE -1
+
+// Events reported by game_step, for the front end's sounds/effects
+enum {
+    EV_ATE         = 1 << 0, // normal, bonus or power fruit eaten
+    EV_BONUS_SPAWN = 1 << 1,
+    EV_LIFE_LOST   = 1 << 2,
+    EV_GAME_OVER   = 1 << 3,
+    EV_MOVED       = 1 << 4, // the snake advanced this tick
+};
+
+// What ended the last life
+enum { DEATH_NONE = 0, DEATH_WALL, DEATH_SELF, DEATH_BOUNDARY, DEATH_CAUSES };
+
+typedef struct {
+    int x, y;
+    int active;
+    int expires;    // tick after which an unclaimed fruit disappears
+} Fruit;
+
+#define FOOD_POINTS 10  // a normal fruit, times the multiplier
+
+// Power-ups: fruits that appear every so many normal fruits for a while, as
+// laid out in the powerUps table. A new one is a table row and an id here.
+enum { POWERUP_BONUS = 0, POWERUP_SLOW, POWERUPS };
+
+// Timed effects a power-up can start
+enum { EFFECT_NONE = 0, EFFECT_SLOW, EFFECTS };
+
+typedef struct {
+    const char *name;       // for the HUD
+    int every;              // spawns on every this-many-th normal fruit, unless already out
+    double lifetime;        // seconds on the board before it disappears
+    int points;             // when eaten, times the multiplier
+    int effect;             // EFFECT_* started when eaten...
+    double effectSeconds;   // ...for this long
+    int spawnEvent;         // EV_* reported when it is due to spawn
+} PowerUpDef;
+
+extern const PowerUpDef powerUps[POWERUPS];
+
+// timer ids: a power-up's expiry, then an effect's end
+#define TIMER_EXPIRE(powerup) (powerup)
+#define TIMER_EFFECT(effect) (POWERUPS + (effect))
+
+// Whole game, free of raylib and wall-clock time. Time is counted in ticks at
+// `speed` ticks per second; slow mode makes the snake move every other tick.
+//
+// Everything sized by the board (snake ring, layer bits, free-cell set, wall
+// list) lives in the one block `mem`, so a game is this struct plus that
+// block: snapshots and clones are two memcpys, after which the pointers are
+// re-aimed at the destination's own block. The debug check board and the
+// level scratch are per-game workspace and are never copied.
+typedef struct GameState {
+    Board board;
+    Snake snake;
+    Cell *walls;          // every wall cell, packed for iteration (membership: LAYER_WALL)
+    int wallCount;
+    int layout;           // LAYOUT_*
+    Fruit food;
+    Fruit powerup[POWERUPS];
+
+    int difficulty;       // 1=Easy, 2=Medium, 3=Hard
+    int speed;            // ticks per second
+    int multiplier;
+    int lives, score, fruitsEaten;
+    int grow, gameOver;
+    int slowMode, slowEnds;
+    int lastMoveDir;      // direction of the last actual move (reversal guard)
+    int lastDeath;        // DEATH_* of the most recent life lost
+    int tick;
+    TimerWheel timers;    // fruit expiries and effect ends, by tick
+    Rng rng;
+    Board checkBoard;     // scratch for the debug-build occupancy check
+    LevelScratch levelScratch; // reused by every level laid out for this game
+    unsigned char *mem;   // the block behind snake.body, board and walls
+    size_t memSize;
+} GameState;
+
+void game_difficulty(int difficulty, int *speed, int *multiplier, int *lives);
+int game_init(GameState *g, int width, int height, uint64_t seed, int difficulty);
+int game_init_layout(GameState *g, int width, int height, uint64_t seed, int difficulty, int layout);
+void game_reset(GameState *g);
+void game_reseed(GameState *g, uint64_t seed);
+int game_step(GameState *g, int action);
+void game_free(GameState *g);
+void game_arm_timers(GameState *g);
+
+// Snapshots: game_snapshot_size() bytes hold the whole state of a game and
+// restore into any game of the same board size. game_clone copies one game
+// into another (`dst` zeroed or holding a game) and only allocates when dst
+// has no block of the right size yet, so forking a game per candidate move
+// reuses the same few states tick after tick.
+size_t game_snapshot_size(const GameState *g);
+void game_snapshot(const GameState *g, void *buf);
+int game_restore(GameState *g, const void *buf);
+int game_clone(GameState *dst, const GameState *src);
+
+// will the next game_step advance the snake? (slow mode skips every other tick)
+static inline int game_moves_next_tick(const GameState *g) {
+    int t = g->tick + 1;
+    return !(g->slowMode && t <= g->slowEnds && (t & 1));
+}
+
+// tick-based durations
+static inline int game_seconds(const GameState *g, double s) { return (int)(s * g->speed + 0.5); }
+static inline double game_remaining(const GameState *g, int expires) { return (double)(expires - g->tick) / g->speed; }
+
+#endif
@@ -0,0 +1,57 @@
+#include "hud.h"
+#include <string.h>
+
+// texture widths grow in steps of this, so a score gaining a digit rarely reallocates
+#define WIDTH_STEP 64
+
+uint64_t hud_hash(const char *s) {
+    uint64_t h = 14695981039346656037ull;
+    while (*s) { h ^= (unsigned char)*s++; h *= 1099511628211ull; }
+    return h;
+}
+
+// 1 (and remembers `key`) when the text must be re-formatted
+int hud_stale(HudText *t, uint64_t key) {
+    if (t->keyed && t->key == key) return 0;
+    t->key = key; t->keyed = 1;
+    return 1;
+}
+
+// Re-draws the texture only if the text, size or colour changed.
+void hud_set(HudText *t, const char *text, int fontSize, Color color) {
+    if (t->tex.id && t->fontSize == fontSize && !memcmp(&t->color, &color, sizeof(color)) &&
+        strcmp(t->text, text) == 0) return;
+    strncpy(t->text, text, HUD_TEXT_MAX - 1);
+    t->text[HUD_TEXT_MAX - 1] = '\0';
+    t->width = MeasureText(t->text, fontSize);
+    if (!t->tex.id || t->fontSize != fontSize || t->tex.texture.width < t->width) {
+        if (t->tex.id) UnloadRenderTexture(t->tex);
+        int w = (t->width + WIDTH_STEP - 1) / WIDTH_STEP * WIDTH_STEP;
+        t->tex = LoadRenderTexture(w > 0 ? w : WIDTH_STEP, fontSize);
+    }
+    t->fontSize = fontSize;
+    t->color = color;
+    BeginTextureMode(t->tex);
+    ClearBackground(BLANK);
+    DrawText(t->text, 0, 0, fontSize, color);
+    EndTextureMode();
+}
+
+// render textures are stored bottom-up, hence the negative source height
+void hud_draw(const HudText *t, int x, int y) {
+    if (!t->tex.id || !t->width) return;
+    Rectangle src = { 0, 0, (float)t->width, -(float)t->tex.texture.height };
+    DrawTextureRec(t->tex.texture, src, (Vector2){ (float)x, (float)y }, WHITE);
+}
+
+// Fixed text: keyed on the string's address, so a literal is never compared
+// or re-drawn after the first frame.
+void hud_label(HudText *t, const char *text, int fontSize, Color color, int x, int y) {
+    if (hud_stale(t, (uint64_t)(uintptr_t)text)) hud_set(t, text, fontSize, color);
+    hud_draw(t, x, y);
+}
+
+void hud_free(HudText *t) {
+    if (t->tex.id) UnloadRenderTexture(t->tex);
+    memset(t, 0, sizeof(*t));
+}
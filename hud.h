@@ -0,0 +1,36 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include "raylib.h"
+#include <stdint.h>
+
+#define HUD_TEXT_MAX 128
+
+// One piece of on-screen text, rasterized into its own render texture. The
+// caller keys it on the values it shows and formats only when hud_stale says
+// the key moved; the glyphs are re-drawn only when the resulting string,
+// size or colour differ. Every other frame is a single textured quad.
+typedef struct HudText {
+    uint64_t key;             // inputs the text was last formatted from
+    int keyed;                // key is set
+    char text[HUD_TEXT_MAX];  // what the texture shows
+    int fontSize;
+    Color color;
+    int width;                // text extent; the texture is fontSize high
+    RenderTexture2D tex;      // width rounded up, regrown when the text outgrows it
+} HudText;
+
+// fold a value into a key
+static inline uint64_t hud_mix(uint64_t h, long long v) {
+    h ^= (uint64_t)v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+    return h;
+}
+uint64_t hud_hash(const char *s);
+
+int hud_stale(HudText *t, uint64_t key);
+void hud_set(HudText *t, const char *text, int fontSize, Color color);
+void hud_draw(const HudText *t, int x, int y);
+void hud_label(HudText *t, const char *text, int fontSize, Color color, int x, int y);
+void hud_free(HudText *t);
+
+#endif
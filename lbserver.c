@@ -0,0 +1,156 @@
+// Leaderboard service: owns the leaderboard log for every game instance on
+// this machine (protocol in lbservice.h).
+//
+//   lbserver [-f leaderboard.dat] [-s leaderboard.sock]
+//
+// Submissions are gathered for up to LBS_BATCH_MS (or LBS_BATCH_MAX records),
+// appended in one locked write and pushed to every subscriber. Instances
+// started without it, or that lose it, use the log directly under its lock,
+// so the two can run side by side. Ctrl-C writes out anything pending.
+#include "lbservice.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_CLIENTS 64
+#define IDLE_WAIT_MS 500  // how often an idle service checks for shutdown
+#define RETRY_MS 1000     // wait before retrying a batch the log wouldn't take
+#define PENDING_MAX 65536 // submissions held while the log can't be written; more are dropped
+
+typedef struct {
+    LbsConn conn;
+    int subscribed;
+} Client;
+
+static Client clients[MAX_CLIENTS];
+static int clientCount;
+static LogRecord pending[PENDING_MAX];
+static int pendingCount;
+static double flushAt;        // when the pending submissions must be written (or retried)
+static int appendFailed;      // the last write failed; wait for the retry
+static volatile sig_atomic_t quit;
+
+static void on_signal(int sig) { (void)sig; quit = 1; }
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void drop(int i) {
+    lbs_close(&clients[i].conn);
+    clients[i] = clients[--clientCount];
+}
+
+// Append the pending batch and push it, LBS_BATCH_MAX records per message. A
+// subscriber that can't take it is disconnected (and swept from the table by
+// the main loop); it catches up from the log when it notices. If the append
+// fails the batch is kept and retried after RETRY_MS: its submitters were
+// told it was taken.
+static void flush(Leaderboard *lb) {
+    if (!pendingCount) return;
+    long long from;
+    appendFailed = !leaderboard_append(lb, pending, pendingCount, &from, NULL);
+    if (appendFailed) {
+        fprintf(stderr, "lbserver: can't append to %s, keeping %d scores to retry\n", lb->path, pendingCount);
+        flushAt = now_ms() + RETRY_MS;
+        return;
+    }
+    for (int k = 0; k < pendingCount; k += LBS_BATCH_MAX) {
+        int n = pendingCount - k < LBS_BATCH_MAX ? pendingCount - k : LBS_BATCH_MAX;
+        long long at = from + (long long)k * sizeof(LogRecord);
+        for (int i = 0; i < clientCount; i++)
+            if (clients[i].subscribed &&
+                !lbs_send(&clients[i].conn, LBS_RECORDS, pending + k, n, lb->generation, at, at + (long long)n * sizeof(LogRecord)))
+                lbs_close(&clients[i].conn);
+    }
+    pendingCount = 0;
+}
+
+// Queue a submission; a full batch is written at once, unless a failed one is
+// waiting for its retry.
+static void submit(Leaderboard *lb, const LogRecord *r) {
+    if (!leaderboard_record_valid(r)) return;
+    if (pendingCount == PENDING_MAX) {
+        fprintf(stderr, "lbserver: %d scores waiting for %s, dropping one\n", pendingCount, lb->path);
+        return;
+    }
+    if (!pendingCount) flushAt = now_ms() + LBS_BATCH_MS;
+    pending[pendingCount++] = *r;
+    if (pendingCount >= LBS_BATCH_MAX && !appendFailed) flush(lb);
+}
+
+// everything client i has sent so far; 0 if it hung up or broke protocol
+static int serve(Leaderboard *lb, int i) {
+    const LbsHeader *m;
+    int rc;
+    while ((rc = lbs_receive(&clients[i].conn, &m)) > 0) {
+        if (m->type == LBS_SUBSCRIBE) clients[i].subscribed = 1;
+        else if (m->type == LBS_SUBMIT) {
+            const LogRecord *recs = (const LogRecord *)(m + 1);
+            for (unsigned k = 0; k < m->count; k++) submit(lb, &recs[k]);
+        }
+    }
+    return rc == 0;
+}
+
+int main(int argc, char **argv) {
+    const char *logPath = "leaderboard.dat", *sockPath = LBS_SOCKET;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-f") && i + 1 < argc) logPath = argv[++i];
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc) sockPath = argv[++i];
+        else { fprintf(stderr, "usage: %s [-f leaderboard.dat] [-s leaderboard.sock]\n", argv[0]); return 2; }
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+#ifdef SIGPIPE
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    LbsConn listener;
+    if (!lbs_listen(&listener, sockPath)) {
+        fprintf(stderr, "lbserver: can't listen on %s (already running?)\n", sockPath);
+        return 1;
+    }
+    Leaderboard lb;
+    memset(&lb, 0, sizeof(lb));
+    leaderboard_load(&lb, logPath, NULL);
+    printf("lbserver: %d scores in %s, listening on %s\n", lb.index.count, logPath, sockPath);
+
+    LbsConn *conns[MAX_CLIENTS + 1];
+    int ready[MAX_CLIENTS + 1];
+    while (!quit) {
+        for (int i = clientCount - 1; i >= 0; i--) if (clients[i].conn.sock < 0) drop(i);
+        conns[0] = &listener;
+        for (int i = 0; i < clientCount; i++) conns[i + 1] = &clients[i].conn;
+        int wait = IDLE_WAIT_MS;
+        if (pendingCount) {
+            double left = flushAt - now_ms();
+            wait = left > 0 ? (int)left + 1 : 0;
+        }
+        if (lbs_wait(conns, clientCount + 1, ready, wait) > 0) {
+            for (int i = 0; i < clientCount; i++)
+                if (ready[i + 1] && !serve(&lb, i)) lbs_close(&clients[i].conn);
+            if (ready[0]) {
+                LbsConn c;
+                while (lbs_accept(&listener, &c)) {
+                    if (clientCount == MAX_CLIENTS) { lbs_close(&c); continue; }
+                    clients[clientCount].conn = c;
+                    clients[clientCount++].subscribed = 0;
+                }
+            }
+        }
+        if (pendingCount && now_ms() >= flushAt) flush(&lb);
+    }
+
+    flush(&lb);
+    if (pendingCount) fprintf(stderr, "lbserver: %d scores could not be written to %s\n", pendingCount, logPath);
+    for (int i = 0; i < clientCount; i++) lbs_close(&clients[i].conn);
+    lbs_close(&listener);
+    remove(sockPath);
+    leaderboard_free(&lb);
+    return 0;
+}
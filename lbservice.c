@@ -0,0 +1,194 @@
+#include "lbservice.h"
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <afunix.h>
+typedef SOCKET Socket;
+#define BAD_SOCKET INVALID_SOCKET
+#define close_socket closesocket
+#define poll WSAPoll
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+typedef int Socket;
+#define BAD_SOCKET (-1)
+#define close_socket close
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// -------------------- sockets --------------------
+static int net_init(void) {
+#ifdef _WIN32
+    static int ready;
+    WSADATA wsa;
+    if (!ready) ready = WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+    return ready;
+#else
+    return 1;
+#endif
+}
+
+static void set_nonblocking(Socket s) {
+#ifdef _WIN32
+    u_long on = 1;
+    ioctlsocket(s, FIONBIO, &on);
+#else
+    fcntl(s, F_SETFL, fcntl(s, F_GETFL) | O_NONBLOCK);
+#endif
+}
+
+static int would_block(void) {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+static int make_address(struct sockaddr_un *a, const char *path) {
+    memset(a, 0, sizeof(*a));
+    a->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(a->sun_path)) return 0;
+    strcpy(a->sun_path, path);
+    return 1;
+}
+
+// a blocking connection to `path`, or BAD_SOCKET if nobody is listening
+static Socket dial(const char *path) {
+    struct sockaddr_un a;
+    if (!net_init() || !make_address(&a, path)) return BAD_SOCKET;
+    Socket s = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s == BAD_SOCKET) return BAD_SOCKET;
+    if (connect(s, (struct sockaddr *)&a, sizeof(a)) != 0) { close_socket(s); return BAD_SOCKET; }
+    return s;
+}
+
+static void adopt(LbsConn *c, Socket s) {
+    c->sock = s == BAD_SOCKET ? -1 : (int64_t)s;
+    c->inLen = 0;
+}
+
+// Listen on `path`, clearing a socket file left behind by a service that
+// died; 0 if another service is answering there.
+int lbs_listen(LbsConn *c, const char *path) {
+    struct sockaddr_un a;
+    adopt(c, BAD_SOCKET);
+    if (!net_init() || !make_address(&a, path)) return 0;
+    Socket s = dial(path);
+    if (s != BAD_SOCKET) { close_socket(s); return 0; }
+    remove(path);
+    s = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s == BAD_SOCKET) return 0;
+    if (bind(s, (struct sockaddr *)&a, sizeof(a)) != 0 || listen(s, 16) != 0) { close_socket(s); return 0; }
+    set_nonblocking(s);
+    adopt(c, s);
+    return 1;
+}
+
+int lbs_accept(LbsConn *listener, LbsConn *c) {
+    Socket s = accept((Socket)listener->sock, NULL, NULL);
+    if (s == BAD_SOCKET) return 0;
+    set_nonblocking(s);
+    adopt(c, s);
+    return 1;
+}
+
+void lbs_close(LbsConn *c) {
+    if (c->sock >= 0) close_socket((Socket)c->sock);
+    adopt(c, BAD_SOCKET);
+}
+
+// ready[i] is set for each connection with input (or a hangup) waiting;
+// returns how many, 0 on timeout, -1 on error
+int lbs_wait(LbsConn *const *conns, int n, int *ready, int timeoutMs) {
+    struct pollfd fds[n > 0 ? n : 1];
+    for (int i = 0; i < n; i++) { fds[i].fd = (Socket)conns[i]->sock; fds[i].events = POLLIN; fds[i].revents = 0; }
+    int rc = poll(fds, n, timeoutMs);
+    for (int i = 0; i < n; i++) ready[i] = rc > 0 && fds[i].revents != 0;
+    return rc;
+}
+
+// -------------------- messages --------------------
+
+// One whole message or nothing: a message that doesn't fit the socket
+// buffer would leave the stream torn, so the caller drops the connection.
+int lbs_send(LbsConn *c, int type, const LogRecord *recs, int n, uint32_t generation, int64_t from, int64_t to) {
+    union { LbsHeader header; unsigned char bytes[LBS_MESSAGE_MAX]; } out;
+    if (c->sock < 0 || n < 0 || n > LBS_BATCH_MAX) return 0;
+    memset(&out.header, 0, sizeof(out.header));
+    out.header.magic = LBS_MAGIC;
+    out.header.type = (uint32_t)type;
+    out.header.count = (uint32_t)n;
+    out.header.generation = generation;
+    out.header.from = from; out.header.to = to;
+    size_t len = sizeof(LbsHeader) + sizeof(LogRecord) * (size_t)n;
+    if (n) memcpy(out.bytes + sizeof(LbsHeader), recs, sizeof(LogRecord) * (size_t)n);
+    return send((Socket)c->sock, (const char *)out.bytes, (int)len, MSG_NOSIGNAL) == (int)len;
+}
+
+static size_t message_size(const LbsConn *c) {
+    return sizeof(LbsHeader) + (c->inLen >= sizeof(LbsHeader) ? sizeof(LogRecord) * c->in.header.count : 0);
+}
+
+// Read without blocking. 1 with *msg set when a whole message is in (valid
+// until the next call), 0 if more is still to come, -1 if the peer hung up
+// or sent something that isn't a message.
+int lbs_receive(LbsConn *c, const LbsHeader **msg) {
+    if (c->sock < 0) return -1;
+    if (c->inLen >= sizeof(LbsHeader) && c->inLen == message_size(c)) c->inLen = 0; // last one was handed out
+    for (;;) {
+        if (c->inLen >= sizeof(LbsHeader)) {
+            if (c->in.header.magic != LBS_MAGIC || c->in.header.count > LBS_BATCH_MAX) return -1;
+            if (c->inLen == message_size(c)) { *msg = &c->in.header; return 1; }
+        }
+        int got = recv((Socket)c->sock, (char *)c->in.bytes + c->inLen, (int)(message_size(c) - c->inLen), 0);
+        if (got > 0) { c->inLen += (size_t)got; continue; }
+        if (got < 0 && would_block()) return 0;
+        return -1;
+    }
+}
+
+// -------------------- game side --------------------
+
+// Connect and subscribe; 0 (and c closed) if no service is running at `path`.
+int lbservice_connect(LbsConn *c, const char *path) {
+    adopt(c, dial(path));
+    if (c->sock < 0) return 0;
+    set_nonblocking((Socket)c->sock);
+    if (!lbs_send(c, LBS_SUBSCRIBE, NULL, 0, 0, 0, 0)) { lbs_close(c); return 0; }
+    return 1;
+}
+
+// Hand a score to the service, which appends it and pushes it back to every
+// subscriber. 0 (and the connection closed) if it couldn't be sent, so the
+// caller can write it to the log itself.
+int lbservice_submit(LbsConn *c, const LogRecord *r) {
+    if (c->sock < 0) return 0;
+    if (lbs_send(c, LBS_SUBMIT, r, 1, 0, 0, 0)) return 1;
+    lbs_close(c);
+    return 0;
+}
+
+// Fold in every batch pushed since the last call. If the service went away,
+// the connection is closed and the log re-read. Returns 1 if `lb` changed.
+int lbservice_poll(LbsConn *c, Leaderboard *lb) {
+    const LbsHeader *m;
+    int changed = 0, rc;
+    while ((rc = lbs_receive(c, &m)) > 0) {
+        if (m->type == LBS_RECORDS)
+            changed |= leaderboard_merge(lb, (const LogRecord *)(m + 1), (int)m->count, m->generation, m->from, m->to);
+    }
+    if (rc < 0) {
+        lbs_close(c);
+        changed |= leaderboard_refresh(lb);
+    }
+    return changed;
+}
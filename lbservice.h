@@ -0,0 +1,64 @@
+#ifndef LBSERVICE_H
+#define LBSERVICE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "leaderboard.h"
+
+// Leaderboard service (lbserver.c): one process per machine owns the log and
+// holds its index, so game instances neither write the file nor poll it.
+// Instances connect over a Unix domain socket, subscribe and submit scores.
+// The service gathers submissions for up to LBS_BATCH_MS, appends each batch
+// with one locked write and pushes the new records, with the log offsets
+// they landed at and the log's generation, to every subscriber, which folds them in with
+// leaderboard_merge. When the service isn't running, instances go back to
+// the locked log.
+//
+// A message is an LbsHeader followed by `count` LogRecords.
+#define LBS_SOCKET "leaderboard.sock"
+#define LBS_MAGIC 0x53424C53u   // "SLBS"
+#define LBS_BATCH_MAX 64        // records per message, and per append
+#define LBS_BATCH_MS 20         // longest a submission waits for others to share its write
+
+enum {
+    LBS_SUBSCRIBE = 1,  // game: push me every batch
+    LBS_SUBMIT,         // game: records to append
+    LBS_RECORDS,        // service: a batch now sits at [from, to) in the log
+};
+
+typedef struct {
+    uint32_t magic;
+    uint32_t type;
+    uint32_t count;
+    uint32_t generation;       // LBS_RECORDS: of the log the batch was appended to
+    int64_t from, to;
+} LbsHeader;
+
+#define LBS_MESSAGE_MAX (sizeof(LbsHeader) + LBS_BATCH_MAX * sizeof(LogRecord))
+
+// One end of a connection, non-blocking, with the message being received.
+// The socket is kept as an integer so this header needs no platform socket
+// headers (winsock and raylib don't mix).
+typedef struct {
+    int64_t sock;             // -1 when closed
+    union {
+        LbsHeader header;
+        unsigned char bytes[LBS_MESSAGE_MAX];
+    } in;
+    size_t inLen;
+} LbsConn;
+
+// game side
+int lbservice_connect(LbsConn *c, const char *path);
+int lbservice_submit(LbsConn *c, const LogRecord *r);
+int lbservice_poll(LbsConn *c, Leaderboard *lb);
+
+// shared with the service
+int lbs_listen(LbsConn *c, const char *path);
+int lbs_accept(LbsConn *listener, LbsConn *c);
+int lbs_send(LbsConn *c, int type, const LogRecord *recs, int n, uint32_t generation, int64_t from, int64_t to);
+int lbs_receive(LbsConn *c, const LbsHeader **msg);
+int lbs_wait(LbsConn *const *conns, int n, int *ready, int timeoutMs);
+void lbs_close(LbsConn *c);
+
+#endif
@@ -0,0 +1,189 @@
+// Leaderboard log checks: each case builds a log file in the working
+// directory, drives the public API and checks what a fresh load sees.
+//   snake_test
+// Prints one line per failed check and exits non-zero if there were any.
+#include "leaderboard.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define TEST_LOG "test_leaderboard.dat"
+
+static int failures;
+
+#define CHECK(cond) do { if (!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++; } } while (0)
+
+static long long file_size(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long long)st.st_size : -1;
+}
+
+static void write_bytes(const char *path, const void *data, size_t n) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return;
+    fwrite(data, 1, n, f);
+    fclose(f);
+}
+
+static void clean(void) {
+    remove(TEST_LOG);
+    remove(TEST_LOG ".lock");
+    remove(TEST_LOG ".tmp");
+    remove(TEST_LOG ".bad");
+}
+
+// a crash while creating the log leaves part of a header: the next append
+// starts the file over instead of writing records at a skewed offset
+static void test_torn_header(void) {
+    clean();
+    LogHeader h = { LB_MAGIC, LB_VERSION, sizeof(LogRecord), 0 };
+    write_bytes(TEST_LOG, &h, sizeof(h) / 2);
+
+    Leaderboard lb = {0};
+    leaderboard_load(&lb, TEST_LOG, NULL);
+    CHECK(lb.index.count == 0);
+    leaderboard_add(&lb, "alice", 30, 1);
+    leaderboard_add(&lb, "bob", 20, 2);
+    leaderboard_free(&lb);
+    CHECK(file_size(TEST_LOG) == (long long)(sizeof(LogHeader) + 2 * sizeof(LogRecord)));
+
+    Leaderboard fresh = {0};
+    leaderboard_load(&fresh, TEST_LOG, NULL);
+    CHECK(fresh.index.count == 2);
+    CHECK(fresh.count == 2 && fresh.top[0].score == 30 && !strcmp(fresh.top[0].name, "alice"));
+    leaderboard_free(&fresh);
+}
+
+// a log with a whole header of another format is moved aside on the next
+// append rather than written after, where no load would ever see the records
+static void test_foreign_header(void) {
+    clean();
+    unsigned char foreign[sizeof(LogHeader) + 3 * sizeof(LogRecord)];
+    memset(foreign, 0x5A, sizeof(foreign));
+    write_bytes(TEST_LOG, foreign, sizeof(foreign));
+
+    Leaderboard lb = {0};
+    leaderboard_load(&lb, TEST_LOG, NULL);
+    CHECK(lb.index.count == 0);
+    leaderboard_add(&lb, "alice", 30, 1);
+    leaderboard_add(&lb, "bob", 20, 2);
+    leaderboard_free(&lb);
+    CHECK(file_size(TEST_LOG ".bad") == (long long)sizeof(foreign));
+
+    Leaderboard fresh = {0};
+    leaderboard_load(&fresh, TEST_LOG, NULL);
+    CHECK(fresh.index.count == 2 && fresh.top[0].score == 30);
+    leaderboard_free(&fresh);
+}
+
+// the verifier's read-only load indexes everything and leaves the file,
+// and its lock, alone even when a normal load would compact it
+static void test_readonly_load(void) {
+    clean();
+    Leaderboard lb = {0};
+    leaderboard_load(&lb, TEST_LOG, NULL);
+    for (int i = 0; i < 100; i++) leaderboard_add(&lb, "carol", i, 1);
+    leaderboard_free(&lb);
+    remove(TEST_LOG ".lock");
+    long long size = file_size(TEST_LOG);
+
+    Leaderboard ro = {0};
+    leaderboard_open_readonly(&ro, TEST_LOG);
+    CHECK(ro.index.count == 100);
+    CHECK(ro.count == LEADERBOARD_TOP && ro.top[0].score == 99);
+    leaderboard_free(&ro);
+    CHECK(file_size(TEST_LOG) == size);
+    CHECK(file_size(TEST_LOG ".lock") < 0);
+
+    Leaderboard rw = {0};
+    leaderboard_load(&rw, TEST_LOG, NULL); // one player's 100 scores: compacted
+    CHECK(rw.index.count == LEADERBOARD_TOP);
+    leaderboard_free(&rw);
+}
+
+// a compaction plus appends that bring the log back to the size a reader
+// last saw, all within one clock tick, still reach that reader's refresh
+static void test_refresh_after_rewrite(void) {
+    clean();
+    Leaderboard writer = {0}, reader = {0};
+    leaderboard_load(&writer, TEST_LOG, NULL);
+    char name[2] = "a";
+    for (int i = 0; i < 10; i++, name[0]++) leaderboard_add(&writer, name, 100 + i, 1);
+    for (int i = 1; i <= 5; i++) leaderboard_add(&writer, "z", i, 1); // four of these are dead
+    leaderboard_load(&reader, TEST_LOG, NULL);
+    long long size = file_size(TEST_LOG);
+
+    CHECK(leaderboard_compact(&writer));
+    for (int i = 0; i < 4; i++) leaderboard_add(&writer, "k", 200 + i, 1);
+    CHECK(file_size(TEST_LOG) == size);
+
+    CHECK(leaderboard_refresh(&reader));
+    CHECK(reader.index.count == 15 && reader.top[0].score == 203);
+    leaderboard_free(&writer);
+    leaderboard_free(&reader);
+}
+
+// a torn record left at the end by a crashed append is read once: later
+// refreshes see an unchanged log, and the next append still lines up
+static void test_torn_tail(void) {
+    clean();
+    Leaderboard lb = {0};
+    leaderboard_load(&lb, TEST_LOG, NULL);
+    leaderboard_add(&lb, "dave", 10, 1);
+    leaderboard_free(&lb);
+    FILE *f = fopen(TEST_LOG, "ab");
+    if (f) { fwrite("torn", 4, 1, f); fclose(f); }
+
+    Leaderboard reader = {0};
+    leaderboard_load(&reader, TEST_LOG, NULL);
+    CHECK(reader.index.count == 1);
+    CHECK(!leaderboard_refresh(&reader));
+    CHECK(!leaderboard_refresh(&reader));
+
+    Leaderboard writer = {0};
+    leaderboard_load(&writer, TEST_LOG, NULL);
+    leaderboard_add(&writer, "erin", 20, 1);
+    leaderboard_free(&writer);
+    CHECK(leaderboard_refresh(&reader));
+    CHECK(reader.index.count == 2 && reader.top[0].score == 20);
+    leaderboard_free(&reader);
+}
+
+// a batch reported at the offset a reader stopped at, but in a log compacted
+// since, is not taken as the next records: the reader re-reads the log
+static void test_merge_after_rewrite(void) {
+    clean();
+    Leaderboard writer = {0}, reader = {0};
+    leaderboard_load(&writer, TEST_LOG, NULL);
+    char name[2] = "a";
+    for (int i = 0; i < 10; i++, name[0]++) leaderboard_add(&writer, name, 100 + i, 1);
+    for (int i = 1; i <= 5; i++) leaderboard_add(&writer, "z", i, 1); // four of these are dead
+    leaderboard_load(&reader, TEST_LOG, NULL);
+
+    CHECK(leaderboard_compact(&writer));
+    LogRecord r;
+    long long from = 0, to = 0;
+    for (int i = 0; i < 5; i++) {
+        leaderboard_record(&r, "k", 200 + i, 1);
+        leaderboard_append(&writer, &r, 1, &from, &to);
+    }
+    CHECK(from == reader.read);
+
+    CHECK(leaderboard_merge(&reader, &r, 1, writer.generation, from, to));
+    CHECK(reader.index.count == 16 && reader.top[0].score == 204 && reader.top[1].score == 203);
+    leaderboard_free(&writer);
+    leaderboard_free(&reader);
+}
+
+int main(void) {
+    test_torn_header();
+    test_foreign_header();
+    test_readonly_load();
+    test_refresh_after_rewrite();
+    test_torn_tail();
+    test_merge_after_rewrite();
+    clean();
+    if (failures) { printf("%d check(s) failed\n", failures); return 1; }
+    printf("all checks passed\n");
+    return 0;
+}
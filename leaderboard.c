@@ -0,0 +1,411 @@
+#include "leaderboard.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// compact on load once dead records outnumber the live set by this factor
+#define COMPACT_SLACK 4
+
+// A single stat(): returns 0 (and a zeroed stamp) if there is no log. The
+// id is the inode where there is one; Windows has none, but there the
+// creation time moves when compaction renames its new file over the log.
+static int file_stamp(const char *path, LogStamp *s) {
+    struct stat st;
+    memset(s, 0, sizeof(*s));
+    if (stat(path, &st) != 0) return 0;
+    s->size = (long long)st.st_size;
+    s->mtime = (long long)st.st_mtime;
+#ifdef _WIN32
+    s->id = (long long)st.st_ctime;
+#else
+    s->id = (long long)st.st_ino;
+#endif
+    return 1;
+}
+
+static int same_stamp(const LogStamp *a, const LogStamp *b) {
+    return a->size == b->size && a->mtime == b->mtime && a->id == b->id;
+}
+
+// -------------------- cross-process lock --------------------
+// Every instance (and the leaderboard service) appends, compacts and reads
+// the log under this lock: exclusive to write, shared to read, so nobody
+// sees half a record or appends into a file being swapped out. It is held on
+// a "<log>.lock" side file because compaction replaces the log itself. If the
+// lock file can't be opened the log is used unlocked, as before.
+typedef struct {
+#ifdef _WIN32
+    HANDLE file;
+#else
+    int fd;
+#endif
+} LogLock;
+
+static void lock_log(const char *path, int exclusive, LogLock *l) {
+    char lockPath[512];
+    snprintf(lockPath, sizeof(lockPath), "%s.lock", path);
+#ifdef _WIN32
+    l->file = CreateFileA(lockPath, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                          NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (l->file == INVALID_HANDLE_VALUE) return;
+    OVERLAPPED ov;
+    memset(&ov, 0, sizeof(ov));
+    LockFileEx(l->file, exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0, 0, MAXDWORD, MAXDWORD, &ov);
+#else
+    l->fd = open(lockPath, O_RDWR | O_CREAT, 0644);
+    if (l->fd >= 0) flock(l->fd, exclusive ? LOCK_EX : LOCK_SH);
+#endif
+}
+
+static void unlock_log(LogLock *l) {
+#ifdef _WIN32
+    if (l->file != INVALID_HANDLE_VALUE) CloseHandle(l->file); // releases the lock
+#else
+    if (l->fd >= 0) close(l->fd);
+#endif
+}
+
+// -------------------- read-only file mapping --------------------
+typedef struct {
+    const unsigned char *data;
+    size_t len;
+#ifdef _WIN32
+    HANDLE file, map;
+#endif
+} Mapping;
+
+static int map_file(const char *path, Mapping *m) {
+    memset(m, 0, sizeof(*m));
+#ifdef _WIN32
+    m->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                          NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m->file == INVALID_HANDLE_VALUE) return 0;
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(m->file, &sz) || sz.QuadPart == 0) { CloseHandle(m->file); return 0; }
+    m->map = CreateFileMappingA(m->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!m->map) { CloseHandle(m->file); return 0; }
+    m->data = MapViewOfFile(m->map, FILE_MAP_READ, 0, 0, 0);
+    if (!m->data) { CloseHandle(m->map); CloseHandle(m->file); return 0; }
+    m->len = (size_t)sz.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return 0; }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return 0;
+    m->data = p;
+    m->len = (size_t)st.st_size;
+#endif
+    return 1;
+}
+
+static void unmap_file(Mapping *m) {
+    if (!m->data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(m->data); CloseHandle(m->map); CloseHandle(m->file);
+#else
+    munmap((void *)m->data, m->len);
+#endif
+    m->data = NULL;
+}
+
+// -------------------- records --------------------
+static uint32_t record_checksum(const LogRecord *r) {
+    LogRecord tmp = *r;
+    tmp.checksum = 0;
+    const unsigned char *p = (const unsigned char *)&tmp;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < sizeof(tmp); i++) { h ^= p[i]; h *= 16777619u; }
+    return h;
+}
+
+int leaderboard_record_valid(const LogRecord *r) {
+    return r->nameLen > 0 && r->nameLen < MAX_NAME_LEN && r->checksum == record_checksum(r);
+}
+
+static void make_record(LogRecord *r, const char *name, int score, int difficulty, long long timestamp) {
+    memset(r, 0, sizeof(*r));
+    size_t n = strlen(name);
+    if (n > MAX_NAME_LEN - 1) n = MAX_NAME_LEN - 1;
+    memcpy(r->name, name, n);
+    r->nameLen = (uint8_t)n;
+    r->score = score;
+    r->difficulty = (uint8_t)difficulty;
+    r->timestamp = timestamp;
+    r->checksum = record_checksum(r);
+}
+
+static void index_record(Leaderboard *lb, const LogRecord *r) {
+    char name[MAX_NAME_LEN];
+    memcpy(name, r->name, r->nameLen);
+    name[r->nameLen] = '\0';
+    int i = scoreindex_insert(&lb->index, name, r->score);
+    if (i < 0) return;
+    lb->index.pool[i].difficulty = r->difficulty;
+    lb->index.pool[i].timestamp = r->timestamp;
+}
+
+static int header_valid(const LogHeader *h) {
+    return h->magic == LB_MAGIC && h->version == LB_VERSION && h->recordSize == sizeof(LogRecord);
+}
+
+// Index records in [from, len) of the mapped log. Torn or corrupt records
+// fail the checksum and are skipped; if the log was compacted since it was
+// last read, the offsets mean nothing and it is read again from the start.
+// Returns the offset read up to, or -1 if the header doesn't match this build.
+static long long scan_records(Leaderboard *lb, const Mapping *m, long long from) {
+    const LogHeader *h = (const LogHeader *)m->data;
+    if (m->len < sizeof(LogHeader) || !header_valid(h)) return -1;
+    if (from > 0 && h->generation != lb->generation) { scoreindex_reset(&lb->index); from = 0; } // compacted since
+    lb->generation = h->generation;
+    if (from < (long long)sizeof(LogHeader)) from = sizeof(LogHeader);
+    long long end = (long long)m->len;
+    for (; from + (long long)sizeof(LogRecord) <= end; from += sizeof(LogRecord)) {
+        LogRecord r;
+        memcpy(&r, m->data + from, sizeof(r));
+        if (leaderboard_record_valid(&r)) index_record(lb, &r);
+    }
+    return from;
+}
+
+static int write_header(FILE *f, uint32_t generation) {
+    LogHeader h = { LB_MAGIC, LB_VERSION, sizeof(LogRecord), generation };
+    return fwrite(&h, sizeof(h), 1, f) == 1;
+}
+
+// Move a log this build can't read to "<log>.bad", replacing an older one,
+// so whoever wrote it can still have it.
+static int move_aside(const char *path) {
+    char bad[512];
+    snprintf(bad, sizeof(bad), "%s.bad", path);
+#ifdef _WIN32
+    return MoveFileExA(path, bad, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(path, bad) == 0;
+#endif
+}
+
+// Append records, padding a torn tail so the new ones land on a record
+// boundary; *start and *end (if given) get the offsets they were written at.
+// A new file gets a header of the given generation, and so does one whose
+// header was torn (a crash while creating it): no records can follow it. A
+// whole header of another format is moved aside first, since scan_records
+// would reject everything appended after it.
+static int append_records(const char *path, uint32_t generation, const LogRecord *recs, int n,
+                          long long *start, long long *end) {
+    FILE *f = fopen(path, "a+b");
+    if (!f) return 0;
+    fseek(f, 0, SEEK_END);
+    long pos = ftell(f);
+    LogHeader h;
+    int whole = pos >= (long)sizeof(LogHeader);
+    if (pos > 0 && !(whole && fseek(f, 0, SEEK_SET) == 0 && fread(&h, sizeof(h), 1, f) == 1 && header_valid(&h))) {
+        fclose(f);
+        if (whole && !move_aside(path)) return 0;
+        if (!(f = fopen(path, "wb"))) return 0;
+        pos = 0;
+    }
+    fseek(f, 0, SEEK_END); // appends land at the end anyway, but a read must be followed by a seek
+    int ok = 1;
+    if (pos <= 0) ok = write_header(f, generation);
+    else {
+        long rem = (pos - (long)sizeof(LogHeader)) % (long)sizeof(LogRecord);
+        if (rem) { static const char zero[sizeof(LogRecord)]; ok = fwrite(zero, sizeof(LogRecord) - rem, 1, f) == 1; }
+    }
+    long at = ftell(f);
+    if (ok && n > 0) ok = fwrite(recs, sizeof(LogRecord), n, f) == (size_t)n;
+    if (fclose(f) != 0) ok = 0;
+    if (start) *start = at;
+    if (end) *end = at + (long long)n * sizeof(LogRecord);
+    return ok;
+}
+
+// one-time import of the old whitespace-separated text leaderboard
+static void import_text(const char *path, const char *textPath) {
+    FILE *f = fopen(textPath, "r");
+    if (!f) return;
+    int n = 0, cap = 64;
+    LogRecord *recs = malloc(sizeof(LogRecord) * cap);
+    char name[MAX_NAME_LEN]; int sc;
+    while (recs && fscanf(f, "%29s %d", name, &sc) == 2) {
+        if (n == cap) {
+            LogRecord *p = realloc(recs, sizeof(LogRecord) * cap * 2);
+            if (!p) break;
+            recs = p; cap *= 2;
+        }
+        make_record(&recs[n++], name, sc, 0, 0);
+    }
+    fclose(f);
+    if (recs) append_records(path, 0, recs, n, NULL, NULL);
+    free(recs);
+}
+
+// -------------------- loading --------------------
+// read the log from `from` onwards; a full reload resets the index first
+static void load_from(Leaderboard *lb, long long from) {
+    if (from == 0) scoreindex_reset(&lb->index);
+    lb->exists = file_stamp(lb->path, &lb->stamp);
+
+    Mapping m;
+    long long end = 0;
+    if (lb->exists && map_file(lb->path, &m)) {
+        end = scan_records(lb, &m, from);
+        unmap_file(&m);
+    }
+    // stop at the last whole record, so a torn tail is read again once an
+    // append pads it out; the stamp still covers it, so it isn't rescanned
+    lb->read = end > 0 ? end : 0;
+    lb->count = scoreindex_top(&lb->index, lb->top, LEADERBOARD_TOP);
+}
+
+// re-read whatever changed since the stamp; the caller holds the lock. Growth
+// is read on from the last record; scan_records starts over by itself if the
+// header shows a compaction in between.
+static int sync_locked(Leaderboard *lb) {
+    LogStamp s;
+    int exists = file_stamp(lb->path, &s);
+    if (exists == lb->exists && same_stamp(&s, &lb->stamp)) return 0;
+    if (exists && lb->exists && lb->read > 0 && s.size >= lb->read) load_from(lb, lb->read);
+    else load_from(lb, 0);
+    return 1;
+}
+
+void leaderboard_load(Leaderboard *lb, const char *path, const char *importTextPath) {
+    lb->path = path;
+    scoreindex_init(&lb->index);
+    LogStamp stamp;
+    LogLock lock;
+    lock_log(path, 1, &lock);
+    if (!file_stamp(path, &stamp) && importTextPath) import_text(path, importTextPath);
+    load_from(lb, 0);
+    unlock_log(&lock);
+
+    // online compaction: drop records that can no longer reach the top-K or a personal best
+    int live = lb->index.bestCount + LEADERBOARD_TOP;
+    if (lb->index.count > COMPACT_SLACK * live) leaderboard_compact(lb);
+}
+
+// Map and index the log as it stands, for tools that audit it: no lock
+// file, no import, no compaction. Torn records fail their checksum, and a
+// compaction swapping the file in meanwhile leaves the mapping on the old one.
+void leaderboard_open_readonly(Leaderboard *lb, const char *path) {
+    lb->path = path;
+    scoreindex_init(&lb->index);
+    load_from(lb, 0);
+}
+
+// cheap stat(); returns 1 if the file changed underneath us and was re-read.
+// Growth is treated as appended records and only the new tail is indexed.
+int leaderboard_refresh(Leaderboard *lb) {
+    LogStamp s;
+    int exists = file_stamp(lb->path, &s);
+    if (exists == lb->exists && same_stamp(&s, &lb->stamp)) return 0;
+    LogLock lock;
+    lock_log(lb->path, 0, &lock);
+    sync_locked(lb);
+    unlock_log(&lock);
+    return 1;
+}
+
+// a record for `name` stamped now, ready to append or submit
+void leaderboard_record(LogRecord *r, const char *name, int score, int difficulty) {
+    make_record(r, name, score, difficulty, (long long)time(NULL));
+}
+
+// Append records as one write and fold them into the index without
+// re-reading the file; *from and *to (if given) get the log offsets they
+// now occupy. Outside writes are picked up first, under the same lock.
+int leaderboard_append(Leaderboard *lb, const LogRecord *recs, int n, long long *from, long long *to) {
+    LogLock lock;
+    long long start, end;
+    lock_log(lb->path, 1, &lock);
+    sync_locked(lb);
+    int ok = append_records(lb->path, lb->generation, recs, n, &start, &end);
+    if (ok) {
+        for (int i = 0; i < n; i++) index_record(lb, &recs[i]);
+        lb->count = scoreindex_top(&lb->index, lb->top, LEADERBOARD_TOP);
+        lb->exists = file_stamp(lb->path, &lb->stamp); // nobody else writes under the lock
+        lb->read = end;
+        if (from) *from = start;
+        if (to) *to = end;
+    }
+    unlock_log(&lock);
+    return ok;
+}
+
+void leaderboard_add(Leaderboard *lb, const char *name, int score, int difficulty) {
+    LogRecord r;
+    leaderboard_record(&r, name, score, difficulty);
+    leaderboard_append(lb, &r, 1, NULL, NULL);
+}
+
+// Fold in records someone else appended at [from, to) of the log of the given
+// generation, as the leaderboard service reports them. If they don't follow
+// on from what this copy has read (it missed a write, or the log was
+// compacted) the file is re-read instead. Returns 1 if anything changed.
+int leaderboard_merge(Leaderboard *lb, const LogRecord *recs, int n, uint32_t generation, long long from, long long to) {
+    if (!lb->exists || generation != lb->generation || from != lb->read) return leaderboard_refresh(lb);
+    for (int i = 0; i < n; i++) if (leaderboard_record_valid(&recs[i])) index_record(lb, &recs[i]);
+    lb->count = scoreindex_top(&lb->index, lb->top, LEADERBOARD_TOP);
+    lb->read = to;     // the stamp is left behind: a later refresh finds nothing past `to`
+    return 1;
+}
+
+static int compact_locked(Leaderboard *lb) {
+    sync_locked(lb);
+    ScoreIndex *ix = &lb->index;
+    if (ix->count == 0) return 1;
+    unsigned char *keep = calloc(ix->count, 1);
+    LogRecord *recs = malloc(sizeof(LogRecord) * ix->count);
+    if (!keep || !recs) { free(keep); free(recs); return 0; }
+    for (int k = 0; k < LEADERBOARD_TOP && k < ix->count; k++) keep[scoreindex_select(ix, k) - ix->pool] = 1;
+    for (int i = 0; i < ix->bestCap; i++) if (ix->best[i] >= 0) keep[ix->best[i]] = 1;
+    int n = 0;
+    for (int i = 0; i < ix->count; i++) {
+        if (!keep[i]) continue;
+        const ScoreNode *s = &ix->pool[i];
+        make_record(&recs[n++], s->name, s->score, s->difficulty, s->timestamp);
+    }
+
+    char tmp[512];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", lb->path);
+    remove(tmp);
+    int ok = append_records(tmp, lb->generation + 1, recs, n, NULL, NULL);
+    free(keep); free(recs);
+    if (!ok) { remove(tmp); return 0; }
+#ifdef _WIN32
+    ok = MoveFileExA(tmp, lb->path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    ok = rename(tmp, lb->path) == 0;
+#endif
+    if (!ok) { remove(tmp); return 0; }
+    load_from(lb, 0);
+    return 1;
+}
+
+// Rewrite the log keeping only the top-K records and each player's best,
+// in original order, then swap it in and reload. Returns 0 on failure.
+int leaderboard_compact(Leaderboard *lb) {
+    LogLock lock;
+    lock_log(lb->path, 1, &lock);
+    int ok = compact_locked(lb);
+    unlock_log(&lock);
+    return ok;
+}
+
+void leaderboard_free(Leaderboard *lb) {
+    scoreindex_free(&lb->index);
+    lb->count = 0;
+}
@@ -0,0 +1,66 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <stdint.h>
+#include "scoreindex.h"
+
+#define LEADERBOARD_TOP 10
+
+// On-disk format: a versioned header followed by fixed-size, checksummed
+// records, appended one per saved score. Loaded with mmap, no parsing.
+#define LB_MAGIC 0x424C4E53u   // "SNLB"
+#define LB_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t generation;       // bumped by every compaction, so readers know offsets moved
+} LogHeader;
+
+typedef struct {
+    int64_t timestamp;
+    int32_t score;
+    uint32_t checksum;         // FNV-1a over the record with this field zeroed
+    uint8_t nameLen;
+    uint8_t difficulty;        // 1..3, 0 = unknown (imported)
+    char name[MAX_NAME_LEN];   // not NUL-terminated on disk
+} LogRecord;
+
+// What stat() said about the log: appends change the size (and mtime), and a
+// compaction swaps in a new file with a new id, so a reader can tell the
+// cache is current without opening the file.
+typedef struct {
+    long long size, mtime;
+    long long id;              // inode, or creation time on Windows
+} LogStamp;
+
+// Resident leaderboard: every live record in a balanced score index, plus
+// the materialized top-K the panel draws. Loaded once, kept current by
+// leaderboard_add, and only the appended tail is read when the file grows.
+// Several processes may share the log: writes and reads take a file lock
+// (see leaderboard.c), and a copy fed by the leaderboard service
+// (lbservice.h) is brought up to date with leaderboard_merge.
+typedef struct Leaderboard {
+    const char *path;
+    ScoreIndex index;
+    PlayerScore top[LEADERBOARD_TOP]; // descending, ties in file order
+    int count;
+    int exists;                       // file was present at last load
+    LogStamp stamp;                   // of the log when it was last read
+    long long read;                   // bytes of the log the cache covers
+    uint32_t generation;              // of the log last read
+} Leaderboard;
+
+void leaderboard_load(Leaderboard *lb, const char *path, const char *importTextPath);
+void leaderboard_open_readonly(Leaderboard *lb, const char *path);
+int leaderboard_refresh(Leaderboard *lb);
+void leaderboard_add(Leaderboard *lb, const char *name, int score, int difficulty);
+void leaderboard_record(LogRecord *r, const char *name, int score, int difficulty);
+int leaderboard_record_valid(const LogRecord *r);
+int leaderboard_append(Leaderboard *lb, const LogRecord *recs, int n, long long *from, long long *to);
+int leaderboard_merge(Leaderboard *lb, const LogRecord *recs, int n, uint32_t generation, long long from, long long to);
+int leaderboard_compact(Leaderboard *lb);
+void leaderboard_free(Leaderboard *lb);
+
+#endif
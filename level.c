@@ -0,0 +1,169 @@
+#include "level.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *layoutNames[LAYOUTS] = { "default", "open", "scatter", "maze" };
+
+// share of the maze's leftover passage walls knocked out to make loops, in percent
+#define MAZE_BRAID 40
+// cells kept clear ahead of the spawn (the snake starts heading right)
+#define SPAWN_CLEARANCE 4
+// random picks per scatter wall before giving up on the rest
+#define SCATTER_TRIES 8
+
+int level_parse(const char *name) {
+    for (int l = 0; l < LAYOUTS; l++) if (!strcmp(name, layoutNames[l])) return l;
+    return -1;
+}
+
+const char *level_name(int layout) {
+    return layout >= 0 && layout < LAYOUTS ? layoutNames[layout] : "?";
+}
+
+// grow the scratch to cover a board of `cells`; 0 if out of memory
+static int scratch_reserve(LevelScratch *s, int cells) {
+    if (cells <= s->cells) return 1;
+    level_scratch_free(s);
+    s->queue = malloc(sizeof(int) * cells);
+    s->reached = malloc(sizeof(uint64_t) * ((cells + 63) / 64));
+    s->seen = malloc(cells);
+    if (!s->queue || !s->reached || !s->seen) { level_scratch_free(s); return 0; }
+    s->cells = cells;
+    return 1;
+}
+
+void level_scratch_free(LevelScratch *s) {
+    free(s->queue); free(s->reached); free(s->seen);
+    memset(s, 0, sizeof(*s));
+}
+
+static int open_at(const Board *b, int x, int y) {
+    return board_in_bounds(b, x, y) && !board_test(b, LAYER_WALL, x, y);
+}
+
+// A wall on (x, y) can't split the open cells if its open side neighbours all
+// join up through the ring of eight cells around it. Going round the ring,
+// every run of open cells that holds a side neighbour is one way out of the
+// cell; two such runs may only meet far away, or not at all, so that counts
+// as a split. Conservative, but O(1) where a flood would be O(cells).
+static int splits(const Board *b, int x, int y) {
+    static const int ring[8][2] = {{0,-1},{1,-1},{1,0},{1,1},{0,1},{-1,1},{-1,0},{-1,-1}};
+    int open[8], runs = 0;
+    for (int i = 0; i < 8; i++) open[i] = open_at(b, x + ring[i][0], y + ring[i][1]);
+    // start from a closed cell so no run wraps round; a ring with none can't split
+    int start = 0;
+    while (start < 8 && open[start]) start++;
+    if (start == 8) return 0;
+    for (int k = 1, side = 0; k <= 8; k++) {
+        int i = (start + k) % 8;
+        if (open[i]) { side |= !(i & 1); continue; }
+        runs += side;
+        side = 0;
+    }
+    return runs > 1;
+}
+
+// `walls` single-cell walls on random free cells, skipping any that could cut
+// the open cells in two, so the level needs no repair afterwards
+static void scatter(Board *b, Rng *rng, int walls) {
+    for (int i = 0, tries = 0; i < walls && tries < walls * SCATTER_TRIES; tries++) {
+        int wx, wy;
+        if (!board_random_free(b, rng, -1, -1, -1, -1, &wx, &wy)) break;
+        if (splits(b, wx, wy)) continue;
+        board_set(b, LAYER_WALL, wx, wy);
+        i++;
+    }
+}
+
+// Rooms sit on even coordinates and pillars on odd/odd ones; the cell between
+// two neighbouring rooms is a passage wall until a randomized depth-first walk
+// carves it. A perfect maze is all dead ends, which a long snake can't survive,
+// so a share of the remaining passage walls is then knocked out as well.
+static void maze(Board *b, Rng *rng, LevelScratch *s) {
+    int rw = (b->width + 1) / 2, rh = (b->height + 1) / 2, rooms = rw * rh;
+    for (int y = 0; y < b->height; y++) {
+        for (int x = 0; x < b->width; x++) {
+            int pillar = (x & 1) && (y & 1);
+            int passage = (x & 1) ? !(y & 1) && x + 1 < b->width : (y & 1) && y + 1 < b->height;
+            if (pillar || passage) board_set(b, LAYER_WALL, x, y);
+        }
+    }
+
+    int *stack = s->queue;
+    unsigned char *seen = s->seen;
+    memset(seen, 0, rooms);
+    static const int step[4][2] = {{0,-1},{1,0},{0,1},{-1,0}};
+    int sp = 0;
+    stack[sp++] = 0; seen[0] = 1;
+    while (sp) {
+        int r = stack[sp - 1], rx = r % rw, ry = r / rw, options[4], n = 0;
+        for (int d = 0; d < 4; d++) {
+            int nx = rx + step[d][0], ny = ry + step[d][1];
+            if (nx >= 0 && nx < rw && ny >= 0 && ny < rh && !seen[ny * rw + nx]) options[n++] = d;
+        }
+        if (!n) { sp--; continue; }
+        int d = options[rng_below(rng, (uint32_t)n)], next = (ry + step[d][1]) * rw + rx + step[d][0];
+        board_clear(b, LAYER_WALL, 2 * rx + step[d][0], 2 * ry + step[d][1]);
+        seen[next] = 1;
+        stack[sp++] = next;
+    }
+
+    for (int y = 0; y < b->height; y++)
+        for (int x = 0; x < b->width; x++)
+            if ((x & 1) != (y & 1) && board_test(b, LAYER_WALL, x, y) && (int)rng_below(rng, 100) < MAZE_BRAID)
+                board_clear(b, LAYER_WALL, x, y);
+}
+
+// Bitmap of the wall-free cells reachable from the spawn, in the scratch
+static uint64_t *reachable(const Board *b, int spawnX, int spawnY, LevelScratch *s) {
+    int qh = 0, qt = 0;
+    int *queue = s->queue;
+    uint64_t *reached = s->reached;
+    memset(reached, 0, sizeof(uint64_t) * b->words);
+    const uint64_t *wall = b->layer[LAYER_WALL];
+    int start = spawnY * b->width + spawnX;
+    queue[qt++] = start; reached[start >> 6] |= (uint64_t)1 << (start & 63);
+    while (qh < qt) {
+        int cur = queue[qh++], cx = cur % b->width, cy = cur / b->width;
+        int next[4] = { cy > 0 ? cur - b->width : -1, cx + 1 < b->width ? cur + 1 : -1,
+                        cy + 1 < b->height ? cur + b->width : -1, cx > 0 ? cur - 1 : -1 };
+        for (int d = 0; d < 4; d++) {
+            int k = next[d];
+            if (k < 0 || ((wall[k >> 6] | reached[k >> 6]) >> (k & 63)) & 1) continue;
+            reached[k >> 6] |= (uint64_t)1 << (k & 63);
+            queue[qt++] = k;
+        }
+    }
+    return reached;
+}
+
+// word w of the wall-free cells the flood missed
+static uint64_t cut_off(const Board *b, const uint64_t *reached, int w) {
+    int cells = b->width * b->height;
+    uint64_t open = ~(b->layer[LAYER_WALL][w] | reached[w]);
+    if (w == b->words - 1 && (cells & 63)) open &= ((uint64_t)1 << (cells & 63)) - 1;
+    return open;
+}
+
+// Lay out obstacles on a board that holds only the freshly spawned snake, then
+// clear the spawn and the cells ahead of it. Both layouts keep every open cell
+// reachable as they build (removing walls can't break that), so food never
+// lands somewhere unreachable. Returns 1 if the finished level validates.
+int level_generate(Board *b, Rng *rng, int layout, int walls, int spawnX, int spawnY, LevelScratch *s) {
+    if (layout == LAYOUT_OPEN) return 1;
+    if (!scratch_reserve(s, b->width * b->height)) return 0;
+    if (layout == LAYOUT_SCATTER) scatter(b, rng, walls);
+    else if (layout == LAYOUT_MAZE) maze(b, rng, s);
+
+    for (int i = 0; i <= SPAWN_CLEARANCE; i++) board_clear(b, LAYER_WALL, spawnX + i, spawnY);
+    return level_connected(b, spawnX, spawnY, s);
+}
+
+// validation: every cell without a wall can be reached from the spawn
+int level_connected(const Board *b, int spawnX, int spawnY, LevelScratch *s) {
+    if (!scratch_reserve(s, b->width * b->height)) return 0;
+    uint64_t *reached = reachable(b, spawnX, spawnY, s);
+    int ok = 1;
+    for (int w = 0; w < b->words && ok; w++) ok = !cut_off(b, reached, w);
+    return ok;
+}
@@ -0,0 +1,33 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+#include "board.h"
+#include "rng.h"
+
+// Obstacle layouts. Walls live on the board's LAYER_WALL bits (O(1)
+// membership); the game keeps a packed list of them for iteration.
+enum {
+    LAYOUT_DEFAULT = 0,   // per difficulty: open on Easy, scattered walls otherwise
+    LAYOUT_OPEN,
+    LAYOUT_SCATTER,       // `walls` single-cell obstacles at random
+    LAYOUT_MAZE,          // braided maze: pillars plus randomly carved passages with loops
+    LAYOUTS
+};
+
+// Work buffers for generation and validation, sized to the largest board seen.
+// Kept by the caller so that laying out a new level doesn't allocate; a
+// zeroed LevelScratch is empty and valid.
+typedef struct LevelScratch {
+    int cells;
+    int *queue;               // flood queue, maze walk stack
+    uint64_t *reached;        // flood bitmap
+    unsigned char *seen;      // maze rooms visited
+} LevelScratch;
+
+int level_generate(Board *b, Rng *rng, int layout, int walls, int spawnX, int spawnY, LevelScratch *s);
+int level_connected(const Board *b, int spawnX, int spawnY, LevelScratch *s);
+void level_scratch_free(LevelScratch *s);
+int level_parse(const char *name);
+const char *level_name(int layout);
+
+#endif
@@ -0,0 +1,238 @@
+#include "lookahead.h"
+#include "ai.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+static const int dirs[4][2] = {{0,-1},{1,0},{0,1},{-1,0}};
+
+// chance in percent that a rollout step takes a random open move instead of the path
+#define ROLLOUT_EPSILON 5
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int lookahead_cpus(void) {
+#ifdef _WIN32
+    SYSTEM_INFO si; GetSystemInfo(&si);
+    return (int)si.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+// ---- rollouts ----
+
+static int open_cell(const GameState *g, int x, int y, Cell tail) {
+    if (!board_in_bounds(&g->board, x, y) || board_test(&g->board, LAYER_WALL, x, y)) return 0;
+    return !board_test(&g->board, LAYER_SNAKE, x, y) || (!g->grow && CELL_PACK(x, y) == tail);
+}
+
+// Rollout policy: the first step of a body-safe shortest path to the active
+// fruit worth most per cell of distance (a power-up that would expire before
+// the snake gets there is skipped). On a random ROLLOUT_EPSILON share of steps,
+// or when that fruit is cut off, a random move into an open cell instead,
+// avoiding dead ends where there is a choice.
+static int rollout_action(const GameState *g, Rng *rng, PathFinder *pf) {
+    const Snake *s = &g->snake;
+    int hx = snake_head_x(s), hy = snake_head_y(s), back = (g->lastMoveDir + 2) % 4;
+    int tx = g->food.x, ty = g->food.y;
+    double best = g->food.active ? (double)FOOD_POINTS / (abs(tx - hx) + abs(ty - hy) + 1) : -1;
+    for (int i = 0; i < POWERUPS; i++) {
+        const Fruit *f = &g->powerup[i];
+        if (!f->active) continue;
+        int d = abs(f->x - hx) + abs(f->y - hy);
+        if (g->tick + d > f->expires) continue;
+        double v = (double)powerUps[i].points / (d + 1);
+        if (v > best) { best = v; tx = f->x; ty = f->y; }
+    }
+    int dir;
+    if (rng_below(rng, 100) >= ROLLOUT_EPSILON &&
+        find_path_to_target(pf, &g->board, s, g->grow, back, tx, ty, &dir)) return dir;
+
+    Cell tail = snake_segment(s, s->length - 1);
+    int open[4], roomy[4], nOpen = 0, nRoomy = 0;
+    for (int d = 0; d < 4; d++) {
+        int nx = hx + dirs[d][0], ny = hy + dirs[d][1];
+        if (d == back || !open_cell(g, nx, ny, tail)) continue;
+        open[nOpen++] = d;
+        int exits = 0;
+        for (int e = 0; e < 4; e++) exits += open_cell(g, nx + dirs[e][0], ny + dirs[e][1], tail);
+        if (exits) roomy[nRoomy++] = d;
+    }
+    if (nRoomy) return roomy[rng_below(rng, nRoomy)];
+    return nOpen ? open[rng_below(rng, nOpen)] : ACTION_NONE;
+}
+
+// Play `first` and then the rollout policy from the root; the value of the
+// outcome, or 0 with *aborted set when the deadline passed on the way. The
+// clock is read before every tick, since one tick can cost a whole BFS.
+static double rollout(Lookahead *la, LookaheadWorker *w, int first, int *aborted) {
+    GameState *g = &w->fork;
+    *aborted = 1;
+    if (now_seconds() >= la->deadline || !game_clone(g, la->root)) return 0;
+    *aborted = 0;
+    if (w->pf.width != g->board.width || w->pf.height != g->board.height) {
+        if (w->pf.width) path_free(&w->pf);
+        if (!path_init(&w->pf, g->board.width, g->board.height)) { memset(&w->pf, 0, sizeof(w->pf)); *aborted = 1; return 0; }
+    }
+    double value = 0, weight = 1;
+    int action = first;
+    for (int t = 0; t < LOOKAHEAD_DEPTH; t++) {
+        if (now_seconds() >= la->deadline) {
+            *aborted = 1;
+            return 0;
+        }
+        int score = g->score;
+        int events = game_step(g, action);
+        value += weight * (g->score - score);
+        if (events & (EV_LIFE_LOST | EV_GAME_OVER)) {
+            value -= weight * LOOKAHEAD_LIFE * g->multiplier;
+            if (events & EV_GAME_OVER) value -= weight * LOOKAHEAD_GAME_OVER * g->multiplier;
+            break;
+        }
+        weight *= LOOKAHEAD_DISCOUNT;
+        action = rollout_action(g, &w->rng, &w->pf);
+    }
+    return value;
+}
+
+static void run_rollouts(Lookahead *la, LookaheadWorker *w) {
+    while (now_seconds() < la->deadline) {
+        int n = __atomic_fetch_add(&la->issued, 1, __ATOMIC_RELAXED);
+        if (n >= la->maxRollouts) break;
+        int c = n % la->candidateCount, aborted;
+        double v = rollout(la, w, la->candidates[c], &aborted);
+        if (aborted) break;
+        w->sum[c] += v; w->count[c]++;
+    }
+}
+
+// ---- pool ----
+
+static void *worker_main(void *arg) {
+    LookaheadWorker *w = arg;
+    Lookahead *la = w->la;
+    unsigned seen = 0;
+    pthread_mutex_lock(&la->lock);
+    for (;;) {
+        while (la->generation == seen && !la->quit) pthread_cond_wait(&la->wake, &la->lock);
+        if (la->quit) break;
+        seen = la->generation;
+        pthread_mutex_unlock(&la->lock);
+        run_rollouts(la, w);
+        pthread_mutex_lock(&la->lock);
+        if (++la->finished == la->threads) pthread_cond_signal(&la->done);
+    }
+    pthread_mutex_unlock(&la->lock);
+    return NULL;
+}
+
+static void free_workers(Lookahead *la) {
+    for (int i = 0; i <= LOOKAHEAD_MAX_THREADS; i++) {
+        if (la->workers[i].fork.mem) game_free(&la->workers[i].fork);
+        if (la->workers[i].pf.width) path_free(&la->workers[i].pf);
+    }
+}
+
+// `threads` pool threads besides the caller (clamped; < 0 = one per spare core),
+// each with its rollout state sized for games like `g` up front, so deciding
+// doesn't allocate. A pool thread that can't be started just leaves the work
+// to the others.
+int lookahead_init(Lookahead *la, int threads, const GameState *g) {
+    memset(la, 0, sizeof(*la));
+    if (threads < 0) threads = lookahead_cpus() - 1;
+    if (threads > LOOKAHEAD_MAX_THREADS) threads = LOOKAHEAD_MAX_THREADS;
+    for (int i = 0; i <= threads; i++) {
+        LookaheadWorker *w = &la->workers[i];
+        w->la = la;
+        if (!game_clone(&w->fork, g) || !path_init(&w->pf, g->board.width, g->board.height)) {
+            free_workers(la);
+            return 0;
+        }
+    }
+    if (pthread_mutex_init(&la->lock, NULL) != 0) { free_workers(la); return 0; }
+    pthread_cond_init(&la->wake, NULL);
+    pthread_cond_init(&la->done, NULL);
+    for (int i = 1; i <= threads; i++) {
+        if (pthread_create(&la->workers[i].thread, NULL, worker_main, &la->workers[i]) != 0) break;
+        la->threads++;
+    }
+    return 1;
+}
+
+// Pick a move for `g`: rollouts until `budgetMs` has passed or `maxRollouts`
+// were handed out. If the budget ran out before every candidate was scored,
+// the greedy ai_choose decides instead: a lone scored move may be a death the
+// others would have avoided. Rollout randomness is seeded from `g` itself, so
+// without a budget the move depends only on the game, not on what the pool
+// played before. `g` must not change until this returns.
+int lookahead_choose(Lookahead *la, const GameState *g, double budgetMs, int maxRollouts) {
+    if (g->gameOver) return ACTION_NONE;
+    la->candidateCount = 0;
+    for (int d = 0; d < 4; d++)
+        if (d != (g->lastMoveDir + 2) % 4) la->candidates[la->candidateCount++] = d;
+    for (int i = 0; i <= la->threads; i++) {
+        memset(la->workers[i].sum, 0, sizeof(la->workers[i].sum));
+        memset(la->workers[i].count, 0, sizeof(la->workers[i].count));
+        rng_seed(&la->workers[i].rng, g->rng.s ^ (uint64_t)g->tick * 0x9E3779B97F4A7C15ull ^ (uint64_t)i << 56);
+    }
+    la->root = g;
+    la->deadline = now_seconds() + budgetMs / 1000.0;
+    la->maxRollouts = maxRollouts > la->candidateCount ? maxRollouts : la->candidateCount;
+    la->issued = la->candidateCount;
+
+    pthread_mutex_lock(&la->lock);
+    la->generation++;
+    la->finished = 0;
+    pthread_cond_broadcast(&la->wake);
+    pthread_mutex_unlock(&la->lock);
+
+    // the caller's first rollout per candidate, then its share of the rest
+    LookaheadWorker *self = &la->workers[0];
+    for (int c = 0; c < la->candidateCount; c++) {
+        int aborted;
+        double v = rollout(la, self, la->candidates[c], &aborted);
+        if (aborted) break;
+        self->sum[c] += v; self->count[c]++;
+    }
+    run_rollouts(la, self);
+
+    pthread_mutex_lock(&la->lock);
+    while (la->finished < la->threads) pthread_cond_wait(&la->done, &la->lock);
+    pthread_mutex_unlock(&la->lock);
+
+    int best = ACTION_NONE, unscored = 0;
+    double bestMean = 0;
+    la->rollouts = 0;
+    for (int c = 0; c < la->candidateCount; c++) {
+        double sum = 0;
+        int count = 0;
+        for (int i = 0; i <= la->threads; i++) { sum += la->workers[i].sum[c]; count += la->workers[i].count[c]; }
+        la->rollouts += count;
+        if (!count) { unscored = 1; continue; }
+        if (best == ACTION_NONE || sum / count > bestMean) { best = la->candidates[c]; bestMean = sum / count; }
+    }
+    return unscored ? ai_choose(&self->pf, g) : best;
+}
+
+void lookahead_free(Lookahead *la) {
+    pthread_mutex_lock(&la->lock);
+    la->quit = 1;
+    pthread_cond_broadcast(&la->wake);
+    pthread_mutex_unlock(&la->lock);
+    for (int i = 1; i <= la->threads; i++) pthread_join(la->workers[i].thread, NULL);
+    free_workers(la);
+    pthread_mutex_destroy(&la->lock);
+    pthread_cond_destroy(&la->wake);
+    pthread_cond_destroy(&la->done);
+}
@@ -0,0 +1,59 @@
+#ifndef LOOKAHEAD_H
+#define LOOKAHEAD_H
+
+#include "game.h"
+#include "path.h"
+#include <pthread.h>
+
+// Monte-Carlo lookahead policy. Each decision forks the game once per
+// rollout (game_clone into a per-thread state, no allocation after the first
+// tick), plays the candidate move and then a randomized shortest-path policy
+// for up to LOOKAHEAD_DEPTH ticks through the real game_step, and scores the
+// outcome: discounted points as the game awards them (bonus, power and slow
+// mode included) minus the worth of a lost life or of the game. The move with
+// the best mean wins. Rollouts run on a pool of worker threads plus the caller
+// and stop at a hard deadline, checked every tick, so a decision overruns its
+// budget by at most one rollout tick; if the budget runs out before every
+// candidate is scored, the greedy ai_choose picks the move.
+#define LOOKAHEAD_MAX_THREADS 64
+#define LOOKAHEAD_DEPTH 48          // ticks played per rollout
+#define LOOKAHEAD_DISCOUNT 0.97     // per tick, so sooner points count more
+#define LOOKAHEAD_LIFE 50           // worth of a life, in points per multiplier
+#define LOOKAHEAD_GAME_OVER 1000    // extra penalty for losing the last one
+
+typedef struct LookaheadWorker {
+    struct Lookahead *la;
+    pthread_t thread;
+    GameState fork;           // reused rollout state
+    PathFinder pf;            // rollout policy's; the caller's also serves the fallback
+    Rng rng;
+    double sum[4];            // per candidate: total value and rollouts this decision
+    int count[4];
+} LookaheadWorker;
+
+typedef struct Lookahead {
+    int threads;              // pool threads besides the caller
+    LookaheadWorker workers[LOOKAHEAD_MAX_THREADS + 1]; // [0] is the caller
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake, done;
+    unsigned generation;      // bumped per decision (under lock)
+    int finished;             // pool threads done with this generation
+    int quit;
+
+    // the decision being worked on; read-only while the pool runs
+    const GameState *root;
+    int candidates[4], candidateCount;
+    double deadline;          // monotonic seconds
+    int maxRollouts;
+    int issued;               // rollouts handed out (atomic)
+
+    int rollouts;             // completed in the last decision, for display
+} Lookahead;
+
+int lookahead_init(Lookahead *la, int threads, const GameState *g);
+int lookahead_choose(Lookahead *la, const GameState *g, double budgetMs, int maxRollouts);
+void lookahead_free(Lookahead *la);
+int lookahead_cpus(void);
+
+#endif
@@ -1,274 +1,406 @@
 #include "raylib.h"
-#include "snake.h"
+#include "game.h"
+#include "ai.h"
+#include "lookahead.h"
+#include "leaderboard.h"
+#include "lbservice.h"
+#include "render.h"
+#include "hud.h"
+#include "replay.h"
+#include "savegame.h"
+#include "arena.h"
+#include "audio.h"
+#include "profile.h"
 #include <stdlib.h>
 #include <time.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
 
-#define CELL_SIZE 20
-#define GRID_WIDTH 30
-#define GRID_HEIGHT 20
-#define MAX_NAME_LEN 30
-#define LEADERBOARD_FILE "leaderboard.txt"
+#define DEFAULT_CELL_SIZE 20
+// larger boards scroll: at most this many cells are on screen, the camera follows the head
+#define MAX_VIEW_COLS 48
+#define MAX_VIEW_ROWS 32
+#define MIN_WINDOW_HEIGHT 400 // room for the leaderboard panel
+#define LEADERBOARD_FILE "leaderboard.dat"
+#define LEADERBOARD_TEXT_FILE "leaderboard.txt" // old format, imported on first run
 #define LEADERBOARD_WIDTH 300
+#define LEADERBOARD_RETRY 2.0     // seconds between attempts to reach the leaderboard service
+#define REPLAY_FILE "replays.dat" // one replay appended per saved score
+#define SAVE_FILE "savegame.dat"  // F5 quick-save, F9 quick-load
+#define ARENA_SPEED 12            // arena ticks per second; F fast-forwards
 
-// Max obstacles possible (actual count depends on difficulty)
-#define MAX_WALLS 8
+// direction inputs buffered between simulation ticks, consumed one per move
+#define INPUT_QUEUE_LEN 3
 
-typedef struct {
-    char name[MAX_NAME_LEN];
-    int score;
-} PlayerScore;
-
-// Wall linked list node
-typedef struct WallNode {
-    Vector2 pos;
-    struct WallNode *next;
-} WallNode;
-
-// Leaderboard BST node
-typedef struct ScoreNode {
-    char name[MAX_NAME_LEN];
-    int score;
-    struct ScoreNode *left, *right;
-} ScoreNode;
+// Monte-Carlo AI: share of a tick's real time it may think, and a rollout cap
+#define LOOKAHEAD_SHARE 0.25
+#define LOOKAHEAD_ROLLOUTS 100000
+
+enum { AI_OFF = 0, AI_GREEDY, AI_LOOKAHEAD };
 
 // ---- Forward declarations ----
-void save_score(const char *name, int score);
-void draw_leaderboard_panel(int startX, const char *currentPlayer);
-
-// Placement helpers
-int on_snake_occ(int x, int y); // uses occupancy grid
-bool wall_at_list(WallNode *walls, int x, int y);
-int get_random_free_cell(Snake *snake, WallNode *walls, int *outX, int *outY);
-int place_random_food_not_on(Snake *snake, WallNode *walls, int *outX, int *outY,
-                              int avoidX1, int avoidY1, int avoidX2, int avoidY2);
-
-// wall list helpers
-WallNode* add_wall(WallNode *head, int x, int y);
-void free_walls(WallNode *head);
-int wall_count_list(WallNode *head);
-
-// occupancy hash-set for snake positions
-static unsigned char occ[GRID_HEIGHT][GRID_WIDTH];
-void rebuild_occupancy_from_snake(Snake *snake) {
-    // clear
-    for (int y = 0; y < GRID_HEIGHT; y++) for (int x = 0; x < GRID_WIDTH; x++) occ[y][x] = 0;
-    if (!snake) return;
-    Node *p = snake->head;
-    while (p) {
-        if (p->x >= 0 && p->x < GRID_WIDTH && p->y >= 0 && p->y < GRID_HEIGHT)
-            occ[p->y][p->x] = 1;
-        p = p->next;
+void save_score(const char *name, int score, int difficulty, Replay *replay);
+void draw_leaderboard_panel(int startX, const char *currentPlayer, int liveScore);
+
+// -------------------- Board rendering --------------------
+// chosen at startup from the command line:
+//   snake_game [-g WxH] [-c cellSize] [-L open|scatter|maze] [-p replayIndex] [-A arenaSnakes]
+static int gridWidth = GRID_WIDTH, gridHeight = GRID_HEIGHT, cellSize = DEFAULT_CELL_SIZE;
+static int layout = LAYOUT_DEFAULT;
+static int viewCols, viewRows;   // cells visible in the game area
+static Lookahead lookahead;      // thread pool started the first time M is pressed
+static int lookaheadStarted;
+
+// Cached HUD text (hud.h): each element is re-formatted only when what it
+// shows changes, e.g. score, lives, rank or a countdown's displayed tenths.
+enum {
+    HUD_MENU_TITLE, HUD_MENU_EASY, HUD_MENU_MEDIUM, HUD_MENU_HARD, HUD_MENU_HINT,
+    HUD_DIFFICULTY, HUD_NAME_PROMPT, HUD_NAME, HUD_NAME_HINT,
+    HUD_SCORE, HUD_COUNTDOWN, HUD_SLOWED = HUD_COUNTDOWN + POWERUPS, HUD_PAUSED,
+    HUD_GAME_OVER, HUD_FINAL, HUD_RESTART, HUD_SAVE_HINT,
+    HUD_LB_TITLE, HUD_LB_EMPTY, HUD_LB_RANK, HUD_LB_ROW,
+    HUD_COUNT = HUD_LB_ROW + LEADERBOARD_TOP
+};
+static HudText hud[HUD_COUNT];
+
+// power-ups are drawn oversized by `inflate` pixels, countdowns in the same colour
+static const struct { Color color; int inflate; } powerUpLook[POWERUPS] = {
+    [POWERUP_BONUS] = { {253, 249, 0, 255}, 3 }, // YELLOW
+    [POWERUP_SLOW]  = { {0, 228, 48, 255}, 2 },  // GREEN
+};
+
+// Walls and the snake body come from the batched BoardView texture; only the
+// moving parts are drawn per frame: the head slides in from the neck and an
+// extra cell slides out of the tail's previous spot. alpha in [0,1].
+void draw_snake(const Snake *snake, int cellSize, Cell prevHead, Cell prevTail, float alpha) {
+    Cell head = snake->body[snake->head], tail = snake_segment(snake, snake->length - 1);
+    float tx = CELL_X(prevTail) + (CELL_X(tail) - CELL_X(prevTail)) * alpha;
+    float ty = CELL_Y(prevTail) + (CELL_Y(tail) - CELL_Y(prevTail)) * alpha;
+    if (snake->length > 1) DrawRectangle((int)(tx * cellSize), (int)(ty * cellSize), cellSize, cellSize, GREEN);
+    float hx = CELL_X(prevHead) + (CELL_X(head) - CELL_X(prevHead)) * alpha;
+    float hy = CELL_Y(prevHead) + (CELL_Y(head) - CELL_Y(prevHead)) * alpha;
+    DrawRectangle((int)(hx * cellSize), (int)(hy * cellSize), cellSize, cellSize, GREEN);
+}
+
+// Whole game area in a constant number of draw calls, whatever the snake
+// length or board size. The camera keeps the (interpolated) head centred,
+// clamped to the board edges; on boards that fit the window it stays at 0,0.
+void draw_board(BoardView *view, const GameState *g, Cell prevHead, Cell prevTail, float alpha) {
+    Cell head = g->snake.body[g->snake.head];
+    float hx = CELL_X(prevHead) + (CELL_X(head) - CELL_X(prevHead)) * alpha;
+    float hy = CELL_Y(prevHead) + (CELL_Y(head) - CELL_Y(prevHead)) * alpha;
+    float camX = hx + 0.5f - viewCols / 2.0f, camY = hy + 0.5f - viewRows / 2.0f;
+    if (camX > g->board.width - viewCols) camX = (float)(g->board.width - viewCols);
+    if (camY > g->board.height - viewRows) camY = (float)(g->board.height - viewRows);
+    if (camX < 0) camX = 0;
+    if (camY < 0) camY = 0;
+
+    boardview_sync(view, &g->board, &g->snake, (int)camX, (int)camY);
+    Camera2D cam = { { 0, 0 }, { camX * cellSize, camY * cellSize }, 0.0f, 1.0f };
+    BeginScissorMode(0, 0, viewCols * cellSize, viewRows * cellSize);
+    BeginMode2D(cam);
+    boardview_draw(view, cellSize);
+    if (!g->gameOver) {
+        DrawRectangle(g->food.x * cellSize, g->food.y * cellSize, cellSize, cellSize, RED);
+        for (int i = 0; i < POWERUPS; i++) {
+            const Fruit *f = &g->powerup[i];
+            int d = powerUpLook[i].inflate;
+            if (f->active) DrawRectangle(f->x * cellSize - d, f->y * cellSize - d, cellSize + 2 * d, cellSize + 2 * d, powerUpLook[i].color);
+        }
+        draw_snake(&g->snake, cellSize, prevHead, prevTail, alpha);
     }
+    EndMode2D();
+    EndScissorMode();
 }
-int on_snake_occ(int x, int y) {
-    if (x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT) return 0;
-    return occ[y][x];
+
+// small FIFO of direction key presses so quick turns between ticks aren't lost
+typedef struct {
+    int dirs[INPUT_QUEUE_LEN];
+    int count;
+} InputQueue;
+
+// drop repeats and reversals of the last direction that will be in effect
+void input_push(InputQueue *q, const GameState *g, int dir) {
+    int last = q->count ? q->dirs[q->count - 1] : g->snake.direction;
+    if (q->count == INPUT_QUEUE_LEN || dir == last || dir == (last + 2) % 4) return;
+    q->dirs[q->count++] = dir;
 }
 
-// ------------------------- BST utilities for leaderboard -------------------------
-ScoreNode* bst_insert(ScoreNode *root, const char *name, int score) {
-    if (!root) {
-        ScoreNode *n = malloc(sizeof(ScoreNode));
-        strncpy(n->name, name, MAX_NAME_LEN);
-        n->name[MAX_NAME_LEN-1] = '\0';
-        n->score = score; n->left = n->right = NULL; return n;
-    }
-    if (score > root->score) root->left = bst_insert(root->left, name, score);
-    else root->right = bst_insert(root->right, name, score);
-    return root;
+int input_pop(InputQueue *q) {
+    if (!q->count) return ACTION_NONE;
+    int dir = q->dirs[0];
+    q->count--;
+    for (int i = 0; i < q->count; i++) q->dirs[i] = q->dirs[i + 1];
+    return dir;
 }
 
-// reverse in-order traversal to collect top N
-void bst_collect_top(ScoreNode *root, PlayerScore *outArr, int *idx, int limit) {
-    if (!root || *idx >= limit) return;
-    bst_collect_top(root->left, outArr, idx, limit);
-    if (*idx < limit) {
-        strncpy(outArr[*idx].name, root->name, MAX_NAME_LEN);
-        outArr[*idx].score = root->score;
-        (*idx)++;
+// -------------------- Leaderboard saving --------------------
+// resident top-10, loaded at startup; kept current by the leaderboard service
+// when it runs (lbserver), otherwise re-read only if the file changes on disk
+static Leaderboard leaderboard;
+static unsigned leaderboardGen; // bumped whenever the resident top-10 may have changed
+static LbsConn lbService = { .sock = -1 };
+static double lbServiceRetry;    // GetTime() of the next connection attempt
+
+// the replay goes to its own log so the score can be re-simulated and verified later
+void save_score(const char *name, int score, int difficulty, Replay *replay) {
+    PROF_BEGIN(PROF_LEADERBOARD);
+    LogRecord r;
+    leaderboard_record(&r, name, score, difficulty);
+    // the service appends it and pushes it back to every instance; without it, write the log ourselves
+    if (!lbservice_submit(&lbService, &r)) {
+        leaderboard_append(&leaderboard, &r, 1, NULL, NULL);
+        leaderboardGen++;
     }
-    if (*idx < limit) bst_collect_top(root->right, outArr, idx, limit);
+    replay_append(replay, REPLAY_FILE, name, score);
+    PROF_END(PROF_LEADERBOARD);
 }
 
-void free_bst(ScoreNode *root) {
-    if (!root) return; free_bst(root->left); free_bst(root->right); free(root);
+// the index-th replay of the log (0 = oldest), skipping damaged records
+static int load_replay(const char *path, int index, Replay *r) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return 0;
+    int rc, found = 0;
+    while ((rc = replay_read(f, r)) != 0) if (rc > 0 && index-- == 0) { found = 1; break; }
+    fclose(f);
+    return found;
 }
 
-// -------------------- Random free cell helpers (enumeration-based) --------------------
-int get_random_free_cell(Snake *snake, WallNode *walls, int *outX, int *outY) {
-    // build occupancy combined
-    unsigned char used[GRID_HEIGHT][GRID_WIDTH];
-    for (int y = 0; y < GRID_HEIGHT; y++) for (int x = 0; x < GRID_WIDTH; x++) used[y][x] = 0;
-
-    // snake
-    if (snake) {
-        Node *p = snake->head;
-        while (p) {
-            if (p->x >= 0 && p->x < GRID_WIDTH && p->y >= 0 && p->y < GRID_HEIGHT)
-                used[p->y][p->x] = 1;
-            p = p->next;
-        }
+// every round gets its own seed, so each recording stands alone
+static uint64_t new_seed(void) {
+    static uint64_t rounds;
+    return (uint64_t)time(NULL) * 0x9E3779B97F4A7C15ull + ++rounds;
+}
+
+// draw leaderboard panel, highlight current player and show where the running score would rank
+void draw_leaderboard_panel(int startX, const char *currentPlayer, int liveScore) {
+    DrawRectangle(startX, 0, LEADERBOARD_WIDTH, GetScreenHeight(), (Color){30,30,30,255});
+    hud_label(&hud[HUD_LB_TITLE], "LEADERBOARD", 25, GOLD, startX + 40, 20);
+
+    PROF_BEGIN(PROF_LEADERBOARD);
+    int changed = 0;
+    if (lbService.sock < 0 && GetTime() >= lbServiceRetry) {
+        lbServiceRetry = GetTime() + LEADERBOARD_RETRY;
+        // once subscribed, catch up on whatever was written before
+        if (lbservice_connect(&lbService, LBS_SOCKET)) changed = leaderboard_refresh(&leaderboard);
     }
-    // walls
-    WallNode *w = walls;
-    while (w) {
-        int wx = (int)w->pos.x, wy = (int)w->pos.y;
-        if (wx >= 0 && wx < GRID_WIDTH && wy >= 0 && wy < GRID_HEIGHT) used[wy][wx] = 1;
-        w = w->next;
+    // batches pushed by the service, or a stat() of the log when it isn't running
+    if (lbService.sock >= 0) changed |= lbservice_poll(&lbService, &leaderboard);
+    else changed |= leaderboard_refresh(&leaderboard);
+    if (changed) leaderboardGen++;
+    PROF_END(PROF_LEADERBOARD);
+
+    // the rank is looked up again only when the score, player or board moved
+    uint64_t board = hud_mix(hud_hash(currentPlayer), leaderboardGen);
+    if (hud_stale(&hud[HUD_LB_RANK], hud_mix(board, liveScore))) {
+        const ScoreIndex *ix = &leaderboard.index;
+        const ScoreNode *best = scoreindex_best(ix, currentPlayer);
+        char rankText[96];
+        if (best) sprintf(rankText, "Live rank: #%d/%d  Best: %d", scoreindex_rank(ix, liveScore), ix->count + 1, best->score);
+        else sprintf(rankText, "Live rank: #%d/%d", scoreindex_rank(ix, liveScore), ix->count + 1);
+        hud_set(&hud[HUD_LB_RANK], rankText, 18, SKYBLUE);
     }
-    int freeCount = 0;
-    for (int y = 0; y < GRID_HEIGHT; y++) for (int x = 0; x < GRID_WIDTH; x++) if (!used[y][x]) freeCount++;
-    if (freeCount == 0) return 0;
-    int pick = rand() % freeCount;
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            if (!used[y][x]) {
-                if (pick == 0) { *outX = x; *outY = y; return 1; }
-                pick--;
-            }
+    hud_draw(&hud[HUD_LB_RANK], startX + 20, GetScreenHeight() - 28);
+
+    if (!leaderboard.exists) {
+        hud_label(&hud[HUD_LB_EMPTY], "No scores yet!", 20, GRAY, startX + 40, 70);
+        return;
+    }
+
+    const PlayerScore *top = leaderboard.top;
+    for (int i = 0; i < leaderboard.count; i++) {
+        HudText *row = &hud[HUD_LB_ROW + i];
+        if (hud_stale(row, board)) {
+            char entry[128]; sprintf(entry, "%2d. %-10s %5d", i+1, top[i].name, top[i].score);
+            if (strcmp(top[i].name, currentPlayer) == 0) hud_set(row, entry, 22, YELLOW);
+            else hud_set(row, entry, 20, RAYWHITE);
         }
+        hud_draw(row, startX + 20, 70 + i*30);
     }
-    return 0;
 }
 
-int place_random_food_not_on(Snake *snake, WallNode *walls, int *outX, int *outY,
-                              int avoidX1, int avoidY1, int avoidX2, int avoidY2) {
-    unsigned char used[GRID_HEIGHT][GRID_WIDTH];
-    for (int y = 0; y < GRID_HEIGHT; y++) for (int x = 0; x < GRID_WIDTH; x++) used[y][x] = 0;
-    if (snake) {
-        Node *p = snake->head;
-        while (p) { if (p->x>=0 && p->x<GRID_WIDTH && p->y>=0 && p->y<GRID_HEIGHT) used[p->y][p->x]=1; p = p->next; }
+#ifdef PROFILE
+// -------------------- Profiler overlay (F3; F4 writes a trace) --------------------
+#define TRACE_FILE "trace.json"
+
+void draw_profiler_overlay(int x, int y) {
+    DrawRectangle(x, y, 270, 40 + 18 * (PROF_PHASES + PROF_MILESTONES), (Color){0, 0, 0, 190});
+    DrawText("phase        min   avg   p99 ms", x + 8, y + 4, 14, GOLD);
+    for (int p = 0; p < PROF_PHASES; p++) {
+        ProfStats st;
+        if (!prof_stats(p, &st)) break;
+        char line[64]; sprintf(line, "%-11s %5.2f %5.2f %5.2f", prof_name(p), st.min, st.avg, st.p99);
+        DrawText(line, x + 8, y + 22 + 18 * p, 14, p == PROF_FRAME ? RAYWHITE : LIGHTGRAY);
+    }
+    // heap allocations per frame; the steady-state loop should show all zeros
+    ProfStats st;
+    if (prof_alloc_stats(&st)) {
+        char line[64]; sprintf(line, "%-11s %5.0f %5.1f %5.0f", "allocs", st.min, st.avg, st.p99);
+        DrawText(line, x + 8, y + 22 + 18 * PROF_PHASES, 14, st.p99 > 0 ? ORANGE : LIGHTGRAY);
+    }
+    // startup: time to first frame and to sounds being attached, from launch
+    for (int m = 0; m < PROF_MILESTONES; m++) {
+        double ms = prof_milestone_ms(m);
+        char line[64];
+        if (ms < 0) sprintf(line, "%-11s     -", prof_milestone_name(m));
+        else sprintf(line, "%-11s %7.1f ms", prof_milestone_name(m), ms);
+        DrawText(line, x + 8, y + 22 + 18 * (PROF_PHASES + 1 + m), 14, SKYBLUE);
     }
-    WallNode *w = walls;
-    while (w) { int wx=(int)w->pos.x, wy=(int)w->pos.y; if (wx>=0 && wx<GRID_WIDTH && wy>=0 && wy<GRID_HEIGHT) used[wy][wx]=1; w=w->next; }
-    if (avoidX1>=0 && avoidY1>=0 && avoidX1<GRID_WIDTH && avoidY1<GRID_HEIGHT) used[avoidY1][avoidX1]=1;
-    if (avoidX2>=0 && avoidY2>=0 && avoidX2<GRID_WIDTH && avoidY2<GRID_HEIGHT) used[avoidY2][avoidX2]=1;
-    int freeCount = 0; for (int y=0;y<GRID_HEIGHT;y++) for (int x=0;x<GRID_WIDTH;x++) if(!used[y][x]) freeCount++;
-    if (freeCount==0) return 0;
-    int pick = rand()%freeCount;
-    for (int y=0;y<GRID_HEIGHT;y++) for (int x=0;x<GRID_WIDTH;x++) if(!used[y][x]) { if (pick==0) { *outX=x; *outY=y; return 1; } pick--; }
-    return 0;
 }
+#endif
 
-// -------------------- Wall list helpers --------------------
-WallNode* add_wall(WallNode *head, int x, int y) {
-    WallNode *n = malloc(sizeof(WallNode)); n->pos.x = (float)x; n->pos.y=(float)y; n->next=NULL;
-    if (!head) return n;
-    // append at end for deterministic order
-    WallNode *p = head; while (p->next) p = p->next; p->next = n; return head;
+// EndDrawing for every screen: whichever presents first marks time to first frame
+static void end_frame(void) {
+    EndDrawing();
+    PROF_MILESTONE(PROF_FIRST_FRAME);
 }
 
-void free_walls(WallNode *head) { WallNode *p = head; while (p) { WallNode *t = p->next; free(p); p = t; } }
+// -------------------- Arena mode (-A) --------------------
+// Many AI snakes on one board, rendered through the same batched BoardView.
+// The camera follows one snake (Tab picks the next live one, highlighted);
+// P pauses, holding F runs 8x.
+int run_arena(BoardView *view, int snakes) {
+    Arena arena;
+    if (!arena_init(&arena, gridWidth, gridHeight, snakes, 0, new_seed(), layout)) return 1;
+    int follow = 0;
+    bool paused = false;
+    double accumulator = 0;
+    SetTargetFPS(GetMonitorRefreshRate(GetCurrentMonitor()));
 
-int wall_count_list(WallNode *head) { int c=0; WallNode *p=head; while(p){c++; p=p->next;} return c; }
+    while (!WindowShouldClose()) {
+        if (IsKeyPressed(KEY_P)) paused = !paused;
+        if (IsKeyPressed(KEY_TAB) || !arena_alive(&arena, follow)) {
+            for (int k = 1; k <= arena.count; k++) {
+                int s = (follow + k) % arena.count;
+                if (arena_alive(&arena, s)) { follow = s; break; }
+            }
+        }
+        if (!paused) {
+            accumulator += GetFrameTime() * (IsKeyDown(KEY_F) ? 8 : 1);
+            if (accumulator > 0.25) accumulator = 0.25;
+            while (accumulator >= 1.0 / ARENA_SPEED) { arena_step(&arena, NULL); accumulator -= 1.0 / ARENA_SPEED; }
+        }
 
-bool wall_at_list(WallNode *walls, int x, int y) {
-    WallNode *p = walls; while (p) { if ((int)p->pos.x==x && (int)p->pos.y==y) return true; p=p->next; } return false;
-}
+        int camX = arena.hx[follow] - viewCols / 2, camY = arena.hy[follow] - viewRows / 2;
+        if (camX > gridWidth - viewCols) camX = gridWidth - viewCols;
+        if (camY > gridHeight - viewRows) camY = gridHeight - viewRows;
+        if (camX < 0) camX = 0;
+        if (camY < 0) camY = 0;
 
-// -------------------- Simple BFS pathfinder for optional AI mode --------------------
-// returns 1 if path found and fills first move in outDir (0 up,1 right,2 down,3 left)
-int find_path_to_target(int sx, int sy, int tx, int ty, WallNode *walls, int *outDir) {
-    // simple BFS that avoids walls; doesn't consider snake body for safety (could be extended)
-    if (sx==tx && sy==ty) return 0;
-    int visited[GRID_HEIGHT][GRID_WIDTH]; for (int y=0;y<GRID_HEIGHT;y++) for (int x=0;x<GRID_WIDTH;x++) visited[y][x]=0;
-    int px[GRID_HEIGHT][GRID_WIDTH], py[GRID_HEIGHT][GRID_WIDTH], pd[GRID_HEIGHT][GRID_WIDTH];
-    typedef struct { int x,y; } Q; Q q[GRID_WIDTH*GRID_HEIGHT]; int qh=0, qt=0;
-    q[qt++] = (Q){sx,sy}; visited[sy][sx]=1; px[sy][sx]=-1;
-    int dirs[4][2] = {{0,-1},{1,0},{0,1},{-1,0}};
-    while (qh<qt) {
-        Q cur = q[qh++]; if (cur.x==tx && cur.y==ty) break;
-        for (int d=0; d<4; d++) {
-            int nx = cur.x + dirs[d][0], ny = cur.y + dirs[d][1];
-            if (nx<0||nx>=GRID_WIDTH||ny<0||ny>=GRID_HEIGHT) continue;
-            if (visited[ny][nx]) continue;
-            if (wall_at_list(walls, nx, ny)) continue;
-            visited[ny][nx]=1; px[ny][nx]=cur.x; py[ny][nx]=cur.y; pd[ny][nx]=d;
-            q[qt++] = (Q){nx,ny};
+        BeginDrawing();
+        ClearBackground(BLACK);
+        boardview_sync(view, &arena.board, NULL, camX, camY);
+        Camera2D cam = { { 0, 0 }, { (float)(camX * cellSize), (float)(camY * cellSize) }, 0.0f, 1.0f };
+        BeginScissorMode(0, 0, viewCols * cellSize, viewRows * cellSize);
+        BeginMode2D(cam);
+        boardview_draw(view, cellSize);
+        for (int f = 0; f < arena.fruitCount; f++) {
+            int c = arena.fruit[f], x = c % gridWidth, y = c / gridWidth;
+            if (c < 0 || x < camX || y < camY || x > camX + viewCols || y > camY + viewRows) continue;
+            DrawRectangle(x * cellSize, y * cellSize, cellSize, cellSize, RED);
         }
+        if (arena_alive(&arena, follow)) {
+            for (int i = 0; i < arena.length[follow]; i++) {
+                int c = arena_segment(&arena, follow, i);
+                DrawRectangle(c % gridWidth * cellSize, c / gridWidth * cellSize, cellSize, cellSize, i ? GOLD : YELLOW);
+            }
+        }
+        EndMode2D();
+        EndScissorMode();
+
+        // side panel: the arena's totals and the top scorers
+        int px = viewCols * cellSize;
+        DrawRectangle(px, 0, LEADERBOARD_WIDTH, GetScreenHeight(), (Color){30,30,30,255});
+        DrawText("ARENA", px + 40, 20, 25, GOLD);
+        char line[96];
+        sprintf(line, "alive %d/%d  tick %lld", arena.alive, arena.count, arena.tick);
+        DrawText(line, px + 20, 60, 18, RAYWHITE);
+        sprintf(line, "deaths: wall %lld body %lld", arena.deaths[ARENA_DEATH_WALL], arena.deaths[ARENA_DEATH_BODY]);
+        DrawText(line, px + 20, 84, 16, LIGHTGRAY);
+        sprintf(line, "head-on %lld", arena.deaths[ARENA_DEATH_HEAD_ON]);
+        DrawText(line, px + 20, 104, 16, LIGHTGRAY);
+        sprintf(line, "following #%d: %d", follow, arena.score[follow]);
+        DrawText(line, px + 20, 130, 18, YELLOW);
+        int top[10], n = 0;
+        for (int s = 0; s < arena.count; s++) {
+            int k = n < 10 ? n++ : 10;
+            if (k == 10 && arena.score[s] <= arena.score[top[9]]) continue;
+            if (k == 10) k = 9;
+            while (k > 0 && arena.score[top[k - 1]] < arena.score[s]) { top[k] = top[k - 1]; k--; }
+            top[k] = s;
+        }
+        for (int i = 0; i < n; i++) {
+            sprintf(line, "%2d. snake %-6d %5d", i + 1, top[i], arena.score[top[i]]);
+            DrawText(line, px + 20, 164 + i * 24, 18, top[i] == follow ? YELLOW : RAYWHITE);
+        }
+        if (paused) DrawText("PAUSED", viewCols * cellSize / 2 - 60, viewRows * cellSize / 2 - 20, 40, YELLOW);
+        end_frame();
     }
-    if (!visited[ty][tx]) return 0;
-    // backtrack to get first move
-    int cx=tx, cy=ty;
-    int prevx = px[cy][cx], prevy = py[cy][cx];
-    while (prevx != -1 && !(prevx==sx && prevy==sy)) {
-        int tx2 = prevx; int ty2 = prevy; prevx = px[ty2][tx2]; prevy = py[ty2][tx2]; cx = tx2; cy = ty2;
-    }
-    // pd[c y][c x] stores direction used to step from parent to this cell; find direction from start
-    // find neighbor of start that is on path
-    for (int d=0; d<4; d++) {
-        int nx = sx + dirs[d][0], ny = sy + dirs[d][1];
-        if (nx==cx && ny==cy) { *outDir = d; return 1; }
-    }
+    arena_free(&arena);
     return 0;
 }
 
-// -------------------- File-based leaderboard saving --------------------
-void save_score(const char *name, int score) {
-    FILE *f = fopen(LEADERBOARD_FILE, "a");
-    if (!f) return;
-    fprintf(f, "%s %d\n", name, score);
-    fclose(f);
+// -------------------- Main --------------------
+static int usage(const char *prog) {
+    fprintf(stderr, "usage: %s [-g WxH] [-c cellSize] [-L open|scatter|maze] [-p replayIndex] [-A arenaSnakes]\n", prog);
+    return 2;
 }
 
-// draw leaderboard panel and highlight current player
-void draw_leaderboard_panel(int startX, const char *currentPlayer) {
-    DrawRectangle(startX, 0, LEADERBOARD_WIDTH, GRID_HEIGHT * CELL_SIZE, (Color){30,30,30,255});
-    DrawText("LEADERBOARD", startX + 40, 20, 25, GOLD);
-
-    FILE *f = fopen(LEADERBOARD_FILE, "r");
-    if (!f) {
-        DrawText("No scores yet!", startX + 40, 70, 20, GRAY);
-        return;
+int main(int argc, char **argv) {
+    PROF_START(); // time to first frame is measured from here
+    int playback = -1; // replay index to watch instead of playing
+    int arenaSnakes = 0; // watch an arena of AI snakes instead
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 == argc) return usage(argv[0]); // every option takes a value
+        if (!strcmp(argv[i], "-g") && sscanf(argv[i+1], "%dx%d", &gridWidth, &gridHeight) == 2) continue;
+        if (!strcmp(argv[i], "-c") && (cellSize = atoi(argv[i+1])) > 0) continue;
+        if (!strcmp(argv[i], "-L") && (layout = level_parse(argv[i+1])) >= 0) continue;
+        if (!strcmp(argv[i], "-p") && (playback = atoi(argv[i+1])) >= 0) continue;
+        if (!strcmp(argv[i], "-A") && (arenaSnakes = atoi(argv[i+1])) > 0) continue;
+        return usage(argv[0]);
     }
 
-    ScoreNode *root = NULL;
-    char name[MAX_NAME_LEN]; int sc;
-    while (fscanf(f, "%s %d", name, &sc) == 2) {
-        root = bst_insert(root, name, sc);
+    // replay being recorded, or the one being played back
+    Replay replay = {0};
+    ReplayCursor cursor = {0};
+    if (playback >= 0) {
+        if (!load_replay(REPLAY_FILE, playback, &replay)) {
+            fprintf(stderr, "no replay #%d in %s\n", playback, REPLAY_FILE);
+            return 1;
+        }
+        gridWidth = replay.width; gridHeight = replay.height;
     }
-    fclose(f);
-
-    PlayerScore top[10]; int idx = 0;
-    // our bst_insert puts higher scores to left; reverse in-order collects descending
-    bst_collect_top(root, top, &idx, 10);
-
-    for (int i = 0; i < idx; i++) {
-        char entry[128]; sprintf(entry, "%2d. %-10s %5d", i+1, top[i].name, top[i].score);
-        if (strcmp(top[i].name, currentPlayer) == 0) DrawText(entry, startX + 20, 70 + i*30, 22, YELLOW);
-        else DrawText(entry, startX + 20, 70 + i*30, 20, RAYWHITE);
+    if (gridWidth < GRID_MIN || gridHeight < GRID_MIN || gridWidth > GRID_MAX || gridHeight > GRID_MAX) {
+        fprintf(stderr, "grid must be between %dx%d and %dx%d\n", GRID_MIN, GRID_MIN, GRID_MAX, GRID_MAX);
+        return 2;
     }
+    viewCols = gridWidth < MAX_VIEW_COLS ? gridWidth : MAX_VIEW_COLS;
+    viewRows = gridHeight < MAX_VIEW_ROWS ? gridHeight : MAX_VIEW_ROWS;
+    int areaW = viewCols * cellSize, areaH = viewRows * cellSize;
 
-    free_bst(root);
-}
-
-// -------------------- Main --------------------
-int main(void) {
-    // Window + audio
-    InitWindow(GRID_WIDTH * CELL_SIZE + LEADERBOARD_WIDTH,
-               GRID_HEIGHT * CELL_SIZE,
+    // Window; render at the monitor's refresh, the simulation has its own clock
+    SetConfigFlags(FLAG_VSYNC_HINT);
+    InitWindow(areaW + LEADERBOARD_WIDTH, areaH > MIN_WINDOW_HEIGHT ? areaH : MIN_WINDOW_HEIGHT,
                "Snake Game in C (Raylib) - DS Enhanced");
-    InitAudioDevice();
-
-    // Load sounds
-    Sound eatSound   = LoadSound("sounds/eat.wav");
-    Sound hitSound   = LoadSound("sounds/hit.wav");
-    Sound bonusSound = LoadSound("sounds/bonus.wav");
-
-    SetSoundVolume(eatSound, 0.7f);
-    SetSoundVolume(hitSound, 1.0f);
-    SetSoundVolume(bonusSound, 0.6f);
+    // one spare row/column for the partly visible cells while scrolling
+    BoardView boardView;
+    if (!boardview_init(&boardView, viewCols + 1, viewRows + 1)) { CloseWindow(); return 1; }
+    if (arenaSnakes) {
+        int rc = run_arena(&boardView, arenaSnakes);
+        boardview_free(&boardView);
+        CloseWindow();
+        return rc;
+    }
+    // audio device and sounds load in the background; the menu doesn't wait for them
+    Audio audio;
+    audio_start(&audio);
+    leaderboard_load(&leaderboard, LEADERBOARD_FILE, LEADERBOARD_TEXT_FILE);
 
-    // Difficulty variables
-    int gameSpeed = 10;        // will change after selection
-    int scoreMultiplier = 1;   // 1=Easy, 2=Medium, 3=Hard
-    int lives = 3;             // changes with difficulty
+    // Difficulty (1=Easy, 2=Medium, 3=Hard); speed, multiplier and lives come from the game core
+    int difficulty = 1;
 
-    // Game state
-    srand((unsigned)time(NULL));
+    // Menu state
     char playerName[MAX_NAME_LEN] = "";
     int nameEntered = 0;
     int letterCount = 0;
@@ -276,63 +408,74 @@ int main(void) {
     // Difficulty selection state
     int difficultySelected = 0; // 0 = not chosen, 1 = chosen
 
-    Snake *snake = NULL;
-    Vector2 food = {0,0};
-    Vector2 bonusFruit = {0,0};
-    Vector2 powerFruit = {0,0};
-    WallNode *walls = NULL;
-
-    int grow = 0, gameOver = 0, score = 0;
-    int fruitsEaten = 0;
-
-    int bonusActive = 0;
-    double bonusStartTime = 0;
-    const double bonusDuration = 5.0;
+    GameState game;
+    int gameStarted = 0;
+    PathFinder pathFinder;
+    if (!path_init(&pathFinder, gridWidth, gridHeight)) { audio_close(&audio); CloseWindow(); return 1; }
 
-    int powerActive = 0;
-    double powerStartTime = 0;
-    const double powerDuration = 7.0;
+    bool paused = false;
+    int aiMode = AI_OFF;
+
+    if (playback >= 0) {
+        gameStarted = replay_game_init(&replay, &game, &cursor);
+        if (!gameStarted) { audio_close(&audio); CloseWindow(); return 1; }
+        difficulty = replay.difficulty;
+        difficultySelected = nameEntered = 1;
+        strcpy(playerName, replay.name);
+    }
 
-    int slowMode = 0;
-    double slowStartTime = 0;
-    const double slowDuration = 5.0;
+    // fixed-timestep simulation: game.speed ticks per second, decoupled from rendering
+    double accumulator = 0;
+    InputQueue inputs = {0};
+    Cell prevHead = 0, prevTail = 0;
+    int lastMoved = 0;
 
-    bool paused = false;
-    bool aiMode = false;
+    SetTargetFPS(GetMonitorRefreshRate(GetCurrentMonitor()));
 
-    SetTargetFPS(gameSpeed);
+#ifdef PROFILE
+    bool showProfiler = false;
+#endif
 
     while (!WindowShouldClose()) {
+        PROF_FRAME();
+        audio_poll(&audio);
         BeginDrawing();
         ClearBackground(BLACK);
 
         // ------------------- Difficulty selection screen -------------------
         if (!difficultySelected) {
-            DrawText("Select Difficulty:", 80, 80, 30, RAYWHITE);
-            DrawText("[1] Easy   (8 FPS,   1x, NO obstacles, 3 lives)", 90, 140, 20, LIGHTGRAY);
-            DrawText("[2] Medium (12 FPS,  2x, obstacles, 5 lives)",   90, 180, 20, LIGHTGRAY);
-            DrawText("[3] Hard   (18 FPS,  3x, obstacles, 8 lives)",   90, 220, 20, LIGHTGRAY);
-            DrawText("Press 1/2/3 to choose", 90, 280, 18, GRAY);
+            hud_label(&hud[HUD_MENU_TITLE], "Select Difficulty:", 30, RAYWHITE, 80, 80);
+            hud_label(&hud[HUD_MENU_EASY], "[1] Easy   (8 FPS,   1x, NO obstacles, 3 lives)", 20, LIGHTGRAY, 90, 140);
+            hud_label(&hud[HUD_MENU_MEDIUM], "[2] Medium (12 FPS,  2x, obstacles, 5 lives)", 20, LIGHTGRAY, 90, 180);
+            hud_label(&hud[HUD_MENU_HARD], "[3] Hard   (18 FPS,  3x, obstacles, 8 lives)", 20, LIGHTGRAY, 90, 220);
+            hud_label(&hud[HUD_MENU_HINT], "Press 1/2/3 to choose", 18, GRAY, 90, 280);
 
-            if (IsKeyPressed(KEY_ONE)) { gameSpeed = 8;  scoreMultiplier = 1; lives = 3; difficultySelected = 1; }
-            else if (IsKeyPressed(KEY_TWO)) { gameSpeed = 12; scoreMultiplier = 2; lives = 5; difficultySelected = 1; }
-            else if (IsKeyPressed(KEY_THREE)) { gameSpeed = 18; scoreMultiplier = 3; lives = 8; difficultySelected = 1; }
+            if (IsKeyPressed(KEY_ONE)) { difficulty = 1; difficultySelected = 1; }
+            else if (IsKeyPressed(KEY_TWO)) { difficulty = 2; difficultySelected = 1; }
+            else if (IsKeyPressed(KEY_THREE)) { difficulty = 3; difficultySelected = 1; }
 
-            EndDrawing();
+            end_frame();
             continue;
         }
 
         // ------------------- Player name input -------------------
         if (!nameEntered) {
-            char diffText[96];
-            sprintf(diffText, "Difficulty: %s  (FPS %d, %dx, Lives: %d)",
-                    (scoreMultiplier==1?"Easy": (scoreMultiplier==2?"Medium":"Hard")),
-                    gameSpeed, scoreMultiplier, lives);
-            DrawText(diffText, 80, 40, 20, LIGHTGRAY);
+            if (hud_stale(&hud[HUD_DIFFICULTY], hud_mix(difficulty, layout))) {
+                int speed, multiplier, lives;
+                game_difficulty(difficulty, &speed, &multiplier, &lives);
+                char diffText[128];
+                sprintf(diffText, "Difficulty: %s  (FPS %d, %dx, Lives: %d)%s%s",
+                        (difficulty==1?"Easy": (difficulty==2?"Medium":"Hard")),
+                        speed, multiplier, lives,
+                        layout != LAYOUT_DEFAULT ? "  Level: " : "", layout != LAYOUT_DEFAULT ? level_name(layout) : "");
+                hud_set(&hud[HUD_DIFFICULTY], diffText, 20, LIGHTGRAY);
+            }
+            hud_draw(&hud[HUD_DIFFICULTY], 80, 40);
 
-            DrawText("Enter your name:", 80, 100, 30, RAYWHITE);
-            DrawText(playerName, 80, 150, 30, GREEN);
-            DrawText("Press ENTER to start", 80, 200, 20, GRAY);
+            hud_label(&hud[HUD_NAME_PROMPT], "Enter your name:", 30, RAYWHITE, 80, 100);
+            if (hud_stale(&hud[HUD_NAME], hud_hash(playerName))) hud_set(&hud[HUD_NAME], playerName, 30, GREEN);
+            hud_draw(&hud[HUD_NAME], 80, 150);
+            hud_label(&hud[HUD_NAME_HINT], "Press ENTER to start", 20, GRAY, 80, 200);
 
             int key = GetCharPressed();
             while (key > 0) {
@@ -351,273 +494,185 @@ int main(void) {
                 nameEntered = 1;
 
                 // initialize game entities
-                if (snake) free_snake(snake);
-                snake = create_snake(GRID_WIDTH/2, GRID_HEIGHT/2);
-                rebuild_occupancy_from_snake(snake);
-
-                // populate walls only if difficulty requires obstacles
-                free_walls(walls); walls = NULL;
-                if (scoreMultiplier > 1) {
-                    for (int i = 0; i < MAX_WALLS; i++) {
-                        int wx, wy;
-                        if (get_random_free_cell(snake, walls, &wx, &wy)) {
-                            walls = add_wall(walls, wx, wy);
-                        }
-                    }
-                }
-
-                // place normal food (avoid clash with snake/walls)
-                int fx, fy;
-                if (get_random_free_cell(snake, walls, &fx, &fy)) { food.x = (float)fx; food.y = (float)fy; }
+                if (gameStarted) game_free(&game);
+                uint64_t seed = new_seed();
+                gameStarted = game_init_layout(&game, gridWidth, gridHeight, seed, difficulty, layout);
+                if (!gameStarted) break;
+                replay_start(&replay, seed, gridWidth, gridHeight, difficulty, layout);
 
-                fruitsEaten = 0;
-                bonusActive = 0;
-                powerActive = 0;
-                slowMode = 0;
-                score = 0;
-                gameOver = 0;
                 paused = false;
-                aiMode = false;
-
-                SetTargetFPS(gameSpeed);
+                aiMode = AI_OFF;
+                accumulator = 0; inputs.count = 0; lastMoved = 0;
             }
 
-            EndDrawing();
+            end_frame();
             continue;
         }
 
         // Pause toggle
+        PROF_BEGIN(PROF_INPUT);
         if (IsKeyPressed(KEY_P)) paused = !paused;
         if (IsKeyPressed(KEY_F11)) ToggleFullscreen();
-        if (IsKeyPressed(KEY_A)) aiMode = !aiMode; // toggle AI mode
+        if (IsKeyPressed(KEY_A) && playback < 0) aiMode = aiMode == AI_GREEDY ? AI_OFF : AI_GREEDY; // toggle AI mode
+        if (IsKeyPressed(KEY_M) && playback < 0) {
+            if (!lookaheadStarted) lookaheadStarted = lookahead_init(&lookahead, -1, &game);
+            if (lookaheadStarted) aiMode = aiMode == AI_LOOKAHEAD ? AI_OFF : AI_LOOKAHEAD;
+        }
+        if (IsKeyPressed(KEY_F5) && playback < 0 && !game.gameOver) {
+            memcpy(replay.name, playerName, sizeof(replay.name));
+            game_save(&game, &replay, SAVE_FILE);
+        }
+        if (IsKeyPressed(KEY_F9) && playback < 0 && game_load(&game, &replay, SAVE_FILE)) {
+            // resume paused, so the player can find the snake first
+            if (replay.name[0]) { strcpy(playerName, replay.name); letterCount = (int)strlen(playerName); }
+            difficulty = game.difficulty;
+            paused = true;
+            accumulator = 0; inputs.count = 0; lastMoved = 0;
+        }
+#ifdef PROFILE
+        if (IsKeyPressed(KEY_F3)) showProfiler = !showProfiler;
+        if (IsKeyPressed(KEY_F4)) prof_export_trace(TRACE_FILE);
+#endif
+        PROF_END(PROF_INPUT);
 
+        Snake *snake = &game.snake;
         if (paused) {
-            DrawText("PAUSED - Press P to resume", 80, 80, 30, GOLD);
-            // still draw current board
-            DrawRectangle(0, 0, GRID_WIDTH * CELL_SIZE, GRID_HEIGHT * CELL_SIZE, (Color){10,10,10,255});
-            // draw walls
-            WallNode *w = walls;
-            while (w) { DrawRectangle((int)w->pos.x * CELL_SIZE, (int)w->pos.y * CELL_SIZE, CELL_SIZE, CELL_SIZE, GRAY); w = w->next; }
-            draw_snake(snake, CELL_SIZE);
-            DrawRectangle((int)food.x * CELL_SIZE, (int)food.y * CELL_SIZE, CELL_SIZE, CELL_SIZE, RED);
-            draw_leaderboard_panel(GRID_WIDTH * CELL_SIZE, playerName);
-            EndDrawing();
+            // still draw current board, frozen on the last tick
+            Cell head = snake->body[snake->head], tail = snake_segment(snake, snake->length - 1);
+            draw_board(&boardView, &game, head, tail, 1.0f);
+            hud_label(&hud[HUD_PAUSED], "PAUSED - Press P to resume", 30, GOLD, 80, 80);
+            draw_leaderboard_panel(areaW, playerName, game.score);
+            end_frame();
             continue;
         }
 
         // ------------------- Game loop (logic) -------------------
-        if (slowMode) {
-            if (GetTime() - slowStartTime > slowDuration) {
-                slowMode = 0; SetTargetFPS(gameSpeed);
-            } else {
-                SetTargetFPS(gameSpeed / 2 > 0 ? gameSpeed / 2 : 1);
-            }
-        } else {
-            SetTargetFPS(gameSpeed);
-        }
-
-        if (!gameOver) {
-            // input (only when not AI mode)
-            if (!aiMode) {
-                if (IsKeyPressed(KEY_UP) && snake->direction != 2) snake->direction = 0;
-                if (IsKeyPressed(KEY_RIGHT) && snake->direction != 3) snake->direction = 1;
-                if (IsKeyPressed(KEY_DOWN) && snake->direction != 0) snake->direction = 2;
-                if (IsKeyPressed(KEY_LEFT) && snake->direction != 1) snake->direction = 3;
-            } else {
-                // AI: compute first move towards food
-                int dir;
-                if (find_path_to_target(snake->head->x, snake->head->y, (int)food.x, (int)food.y, walls, &dir)) {
-                    snake->direction = dir;
-                }
-            }
-
-            move_snake(snake, grow);
-            grow = 0;
-            rebuild_occupancy_from_snake(snake);
-
-            // collision with walls (if any)
-            if (!gameOver) {
-                WallNode *w = walls; bool collidedWall = false;
-                while (w) {
-                    if ((int)w->pos.x == snake->head->x && (int)w->pos.y == snake->head->y) { collidedWall = true; break; }
-                    w = w->next;
-                }
-                if (collidedWall) {
-                    // lose a life or game over
-                    if (lives > 1) {
-                        lives--; // don't play game over sound
-                        // respawn snake in center
-                        free_snake(snake); snake = create_snake(GRID_WIDTH/2, GRID_HEIGHT/2);
-                        rebuild_occupancy_from_snake(snake);
-                        continue; // skip other checks this frame
-                    } else {
-                        // final life lost -> game over
-                        lives = 0; PlaySound(hitSound); gameOver = 1;
-                    }
-                }
-            }
-
-            // Normal food eaten
-            if (!gameOver && snake->head->x == (int)food.x && snake->head->y == (int)food.y) {
-                PlaySound(eatSound);
-                grow = 1;
-                score += 10 * scoreMultiplier;
-                fruitsEaten++;
-
-                // place new normal food — avoid active bonus/power positions
-                int fx, fy;
-                int ax1 = bonusActive ? (int)bonusFruit.x : -1;
-                int ay1 = bonusActive ? (int)bonusFruit.y : -1;
-                int ax2 = powerActive ? (int)powerFruit.x : -1;
-                int ay2 = powerActive ? (int)powerFruit.y : -1;
-                if (place_random_food_not_on(snake, walls, &fx, &fy, ax1, ay1, ax2, ay2)) { food.x = (float)fx; food.y = (float)fy; }
-
-                // spawn bonus every 8 normal fruits
-                if (fruitsEaten % 8 == 0 && !bonusActive) {
-                    PlaySound(bonusSound);
-                    int bx, by;
-                    if (place_random_food_not_on(snake, walls, &bx, &by, (int)food.x, (int)food.y, ax2, ay2)) {
-                        bonusFruit.x = (float)bx; bonusFruit.y = (float)by; bonusStartTime = GetTime(); bonusActive = 1;
-                    }
-                }
-
-                // spawn power (slow) fruit every 12 normal fruits
-                if (fruitsEaten % 12 == 0 && !powerActive) {
-                    int px, py;
-                    if (place_random_food_not_on(snake, walls, &px, &py, (int)food.x, (int)food.y, bonusActive ? (int)bonusFruit.x : -1, bonusActive ? (int)bonusFruit.y : -1)) {
-                        powerFruit.x = (float)px; powerFruit.y = (float)py; powerStartTime = GetTime(); powerActive = 1;
-                    }
-                }
-            }
-
-            // Bonus fruit handling
-            if (bonusActive) {
-                if (GetTime() - bonusStartTime > bonusDuration) {
-                    bonusActive = 0; // disappear
-                } else if (snake->head->x == (int)bonusFruit.x && snake->head->y == (int)bonusFruit.y) {
-                    PlaySound(eatSound);
-                    score += 20 * scoreMultiplier; // double normal * multiplier
-                    grow = 1; bonusActive = 0;
-                }
+        float alpha = 1.0f;
+        if (!game.gameOver) {
+            // input is polled every rendered frame and queued (only when not AI mode)
+            if (!aiMode && playback < 0) {
+                PROF_BEGIN(PROF_INPUT);
+                if (IsKeyPressed(KEY_UP)) input_push(&inputs, &game, 0);
+                if (IsKeyPressed(KEY_RIGHT)) input_push(&inputs, &game, 1);
+                if (IsKeyPressed(KEY_DOWN)) input_push(&inputs, &game, 2);
+                if (IsKeyPressed(KEY_LEFT)) input_push(&inputs, &game, 3);
+                PROF_END(PROF_INPUT);
             }
 
-            // Power fruit handling (green slow fruit)
-            if (powerActive) {
-                if (GetTime() - powerStartTime > powerDuration) {
-                    powerActive = 0; // disappear if not eaten
-                } else if (snake->head->x == (int)powerFruit.x && snake->head->y == (int)powerFruit.y) {
-                    PlaySound(eatSound);
-                    // apply slow effect
-                    slowMode = 1; slowStartTime = GetTime();
-                    // points for power fruit
-                    score += 15 * scoreMultiplier; grow = 1; powerActive = 0;
+            // run as many fixed ticks as real time allows (capped so a stall doesn't fast-forward);
+            // holding F fast-forwards a replay
+            const double tickTime = 1.0 / (game.speed * (playback >= 0 && IsKeyDown(KEY_F) ? 8 : 1));
+            accumulator += GetFrameTime();
+            if (accumulator > 5 * tickTime) accumulator = 5 * tickTime;
+            while (accumulator >= tickTime && !game.gameOver && !(playback >= 0 && replay_done(&cursor))) {
+                accumulator -= tickTime;
+                int action = ACTION_NONE;
+                if (playback >= 0) action = replay_next(&cursor);
+                else if (aiMode == AI_GREEDY) { // AI: compute first move towards food
+                    PROF_BEGIN(PROF_AI);
+                    action = ai_choose(&pathFinder, &game);
+                    PROF_END(PROF_AI);
                 }
-            }
-
-            // boundary/self collision (self collision -> lose life or game over)
-            if (!gameOver && check_collision(snake, GRID_WIDTH, GRID_HEIGHT)) {
-                if (lives > 1) {
-                    lives--;
-                    free_snake(snake); snake = create_snake(GRID_WIDTH/2, GRID_HEIGHT/2);
-                    rebuild_occupancy_from_snake(snake);
-                } else {
-                    lives = 0; PlaySound(hitSound); gameOver = 1;
+                else if (aiMode == AI_LOOKAHEAD) { // rollouts on every core within a slice of the tick
+                    PROF_BEGIN(PROF_AI);
+                    action = lookahead_choose(&lookahead, &game, tickTime * 1000.0 * LOOKAHEAD_SHARE, LOOKAHEAD_ROLLOUTS);
+                    PROF_END(PROF_AI);
                 }
+                else if (game_moves_next_tick(&game)) action = input_pop(&inputs);
+                if (playback < 0) replay_record(&replay, action);
+
+                prevHead = game.snake.body[game.snake.head];
+                prevTail = snake_segment(&game.snake, game.snake.length - 1);
+                PROF_BEGIN(PROF_LOGIC);
+                int events = game_step(&game, action);
+                PROF_END(PROF_LOGIC);
+                lastMoved = (events & EV_MOVED) && !(events & (EV_LIFE_LOST | EV_GAME_OVER));
+                if (events & EV_ATE) audio_play(&audio, SFX_EAT);
+                if (events & EV_BONUS_SPAWN) audio_play(&audio, SFX_BONUS);
+                if (events & EV_GAME_OVER) audio_play(&audio, SFX_HIT);
             }
+            // how far we are towards the next tick, for interpolated drawing
+            alpha = lastMoved ? (float)(accumulator / tickTime) : 1.0f;
         }
 
         // ------------------- Drawing -------------------
-        // game area background
-        DrawRectangle(0, 0, GRID_WIDTH * CELL_SIZE, GRID_HEIGHT * CELL_SIZE, (Color){10,10,10,255});
-
-        // draw walls
-        WallNode *w = walls;
-        while (w) { DrawRectangle((int)w->pos.x * CELL_SIZE, (int)w->pos.y * CELL_SIZE, CELL_SIZE, CELL_SIZE, GRAY); w = w->next; }
-
-        if (!gameOver) {
-            // Normal food
-            DrawRectangle((int)food.x * CELL_SIZE, (int)food.y * CELL_SIZE, CELL_SIZE, CELL_SIZE, RED);
-
-            // Bonus fruit (yellow, larger)
-            if (bonusActive) {
-                int bonusSize = CELL_SIZE + 6;
-                DrawRectangle((int)bonusFruit.x * CELL_SIZE - 3, (int)bonusFruit.y * CELL_SIZE - 3, bonusSize, bonusSize, YELLOW);
-                double remaining = bonusDuration - (GetTime() - bonusStartTime);
-                char bonusText[32]; sprintf(bonusText, "BONUS: %.1fs", remaining);
-                DrawText(bonusText, 10, GRID_HEIGHT * CELL_SIZE - 30, 20, YELLOW);
-            }
-
-            // Power fruit (green, slightly larger)
-            if (powerActive) {
-                int pSize = CELL_SIZE + 4;
-                DrawRectangle((int)powerFruit.x * CELL_SIZE - 2, (int)powerFruit.y * CELL_SIZE - 2, pSize, pSize, GREEN);
-                double prem = powerDuration - (GetTime() - powerStartTime);
-                char ptext[32]; sprintf(ptext, "POWER: %.1fs", prem);
-                DrawText(ptext, 150, GRID_HEIGHT * CELL_SIZE - 30, 20, GREEN);
+        PROF_BEGIN(PROF_DRAW);
+        if (lastMoved) draw_board(&boardView, &game, prevHead, prevTail, alpha);
+        else draw_board(&boardView, &game, snake->body[snake->head], snake_segment(snake, snake->length - 1), 1.0f);
+
+        if (!game.gameOver) {
+            // countdowns are keyed on the tenths they display, not the exact time left
+            for (int i = 0; i < POWERUPS; i++) {
+                const Fruit *f = &game.powerup[i];
+                if (!f->active) continue;
+                int tenths = (int)(game_remaining(&game, f->expires) * 10 + 0.5);
+                if (hud_stale(&hud[HUD_COUNTDOWN + i], tenths)) {
+                    char text[32]; sprintf(text, "%s: %.1fs", powerUps[i].name, tenths / 10.0);
+                    hud_set(&hud[HUD_COUNTDOWN + i], text, 20, powerUpLook[i].color);
+                }
+                hud_draw(&hud[HUD_COUNTDOWN + i], 10 + 140 * i, areaH - 30);
             }
 
-            // Snake
-            draw_snake(snake, CELL_SIZE);
-
             // HUD
-            char scoreText[128]; sprintf(scoreText, "Player: %s   Score: %d   Lives: %d   Mode: %s", playerName, score, lives, aiMode?"AI":"Human");
-            DrawText(scoreText, 10, 10, 20, RAYWHITE);
+            const char *mode = playback >= 0 ? "Replay" : aiMode == AI_LOOKAHEAD ? "Lookahead" : aiMode ? "AI" : "Human";
+            uint64_t key = hud_mix(hud_mix(hud_mix(hud_hash(playerName), game.score), game.lives), (uintptr_t)mode);
+            if (hud_stale(&hud[HUD_SCORE], key)) {
+                char scoreText[128]; sprintf(scoreText, "Player: %s   Score: %d   Lives: %d   Mode: %s", playerName, game.score, game.lives, mode);
+                hud_set(&hud[HUD_SCORE], scoreText, 20, RAYWHITE);
+            }
+            hud_draw(&hud[HUD_SCORE], 10, 10);
 
-            if (slowMode) DrawText("SLOWED!", 300, 10, 20, SKYBLUE);
+            if (game.slowMode) hud_label(&hud[HUD_SLOWED], "SLOWED!", 20, SKYBLUE, 300, 10);
         } else {
-            DrawText("GAME OVER", 100, 100, 40, RED);
-            char finalText[96]; sprintf(finalText, "Player: %s  |  Score: %d", playerName, score);
-            DrawText(finalText, 100, 160, 25, RAYWHITE);
-            DrawText("Press [R] to restart", 100, 200, 20, GRAY);
-            DrawText("Press [L] to save score", 100, 230, 20, GRAY);
+            hud_label(&hud[HUD_GAME_OVER], "GAME OVER", 40, RED, 100, 100);
+            if (hud_stale(&hud[HUD_FINAL], hud_mix(hud_hash(playerName), game.score))) {
+                char finalText[96]; sprintf(finalText, "Player: %s  |  Score: %d", playerName, game.score);
+                hud_set(&hud[HUD_FINAL], finalText, 25, RAYWHITE);
+            }
+            hud_draw(&hud[HUD_FINAL], 100, 160);
+            hud_label(&hud[HUD_RESTART], playback >= 0 ? "Press [R] to watch again" : "Press [R] to restart", 20, GRAY, 100, 200);
+            if (playback < 0) hud_label(&hud[HUD_SAVE_HINT], "Press [L] to save score", 20, GRAY, 100, 230);
 
             if (IsKeyPressed(KEY_R)) {
-                if (snake) free_snake(snake);
-                snake = create_snake(GRID_WIDTH/2, GRID_HEIGHT/2);
-
-                // regenerate walls/fruits based on difficulty
-                free_walls(walls); walls = NULL;
-                if (scoreMultiplier > 1) {
-                    for (int i = 0; i < MAX_WALLS; i++) {
-                        int wx, wy;
-                        if (get_random_free_cell(snake, walls, &wx, &wy)) walls = add_wall(walls, wx, wy);
-                    }
+                if (playback >= 0) {
+                    game_free(&game);
+                    gameStarted = replay_game_init(&replay, &game, &cursor);
+                    if (!gameStarted) break;
+                } else {
+                    // new walls/fruits from a fresh seed, lives back to difficulty defaults
+                    uint64_t seed = new_seed();
+                    game_reseed(&game, seed);
+                    replay_start(&replay, seed, gridWidth, gridHeight, game.difficulty, game.layout);
                 }
-
-                int fx, fy; if (get_random_free_cell(snake, walls, &fx, &fy)) { food.x = (float)fx; food.y = (float)fy; }
-
-                fruitsEaten = 0; bonusActive = 0; powerActive = 0; slowMode = 0; score = 0; gameOver = 0;
-                // reset lives to difficulty defaults
-                if (scoreMultiplier == 1) lives = 3; else if (scoreMultiplier == 2) lives = 5; else lives = 8;
-                SetTargetFPS(gameSpeed);
+                accumulator = 0; inputs.count = 0; lastMoved = 0;
             }
 
-            if (IsKeyPressed(KEY_L)) save_score(playerName, score);
+            if (IsKeyPressed(KEY_L) && playback < 0) save_score(playerName, game.score, game.difficulty, &replay);
         }
 
         // Live leaderboard at right
-        draw_leaderboard_panel(GRID_WIDTH * CELL_SIZE, playerName);
-
-        EndDrawing();
+        draw_leaderboard_panel(areaW, playerName, game.score);
+#ifdef PROFILE
+        if (showProfiler) draw_profiler_overlay(areaW - 280, 40);
+#endif
+        PROF_END(PROF_DRAW);
+
+        PROF_BEGIN(PROF_PRESENT);
+        end_frame();
+        PROF_END(PROF_PRESENT);
     }
 
     // Cleanup
-    if (snake) free_snake(snake);
-    free_walls(walls);
-    UnloadSound(eatSound);
-    UnloadSound(hitSound);
-    UnloadSound(bonusSound);
-    CloseAudioDevice();
+    if (gameStarted) game_free(&game);
+    boardview_free(&boardView);
+    for (int i = 0; i < HUD_COUNT; i++) hud_free(&hud[i]);
+    replay_free(&replay);
+    path_free(&pathFinder);
+    lbs_close(&lbService);
+    leaderboard_free(&leaderboard);
+    if (lookaheadStarted) lookahead_free(&lookahead);
+    audio_close(&audio);
     CloseWindow();
 
     return 0;
 }
-
-
-  
-    
-
-  
-
-                             
-              
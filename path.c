@@ -0,0 +1,241 @@
+#include "path.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const int dirs[4][2] = {{0,-1},{1,0},{0,1},{-1,0}};
+
+int path_init(PathFinder *pf, int width, int height) {
+    int cells = width * height;
+    memset(pf, 0, sizeof(*pf));
+    pf->width = width; pf->height = height;
+    pf->seen = calloc(cells, sizeof(unsigned));
+    pf->bodySeen = calloc(cells, sizeof(unsigned));
+    pf->vacate = malloc(sizeof(int) * cells);
+    pf->queue = malloc(sizeof(int) * cells);
+    pf->dist = malloc(sizeof(int) * cells);
+    pf->parent = malloc(sizeof(int) * cells);
+    pf->first = malloc(cells);
+    pf->path = malloc(sizeof(int) * cells);
+    pf->field = malloc(sizeof(int) * cells);
+    pf->fieldTarget = -1;
+    if (!pf->seen || !pf->bodySeen || !pf->vacate || !pf->queue || !pf->dist || !pf->parent ||
+        !pf->first || !pf->path || !pf->field) {
+        path_free(pf);
+        return 0;
+    }
+    return 1;
+}
+
+void path_free(PathFinder *pf) {
+    free(pf->seen); free(pf->bodySeen); free(pf->vacate);
+    free(pf->queue); free(pf->dist); free(pf->parent); free(pf->first);
+    free(pf->path); free(pf->field);
+    memset(pf, 0, sizeof(*pf));
+}
+
+// next stamp; on wrap-around the stamp arrays are cleared once
+static unsigned next_stamp(PathFinder *pf) {
+    if (++pf->stamp == 0) {
+        int cells = pf->width * pf->height;
+        memset(pf->seen, 0, sizeof(unsigned) * cells);
+        memset(pf->bodySeen, 0, sizeof(unsigned) * cells);
+        pf->stamp = 1;
+    }
+    return pf->stamp;
+}
+
+// Segment i (0 = head) frees its cell once the tail has passed it:
+// after length - i moves, one more if the snake is about to grow.
+static void build_body_map(PathFinder *pf, const Snake *snake, int grow, unsigned stamp) {
+    int i = 0;
+    SNAKE_FOR_EACH(snake, c, {
+        int x = CELL_X(c), y = CELL_Y(c);
+        if (x >= 0 && x < pf->width && y >= 0 && y < pf->height) {
+            int k = y * pf->width + x;
+            pf->bodySeen[k] = stamp;
+            pf->vacate[k] = snake->length - i + grow;
+        }
+        i++;
+    });
+}
+
+static inline int bit_at(const uint64_t *layer, int k) {
+    return (int)((layer[k >> 6] >> (k & 63)) & 1u);
+}
+
+// is in-bounds cell k enterable on move number `t`? (body map built lazily on first body hit)
+static inline int passable(PathFinder *pf, const Board *board, const Snake *snake, int grow,
+                           unsigned stamp, int *bodyBuilt, int k, int t) {
+    if (bit_at(board->layer[LAYER_WALL], k)) return 0;
+    if (!bit_at(board->layer[LAYER_SNAKE], k)) return 1;
+    if (!*bodyBuilt) { build_body_map(pf, snake, grow, stamp); *bodyBuilt = 1; }
+    return pf->bodySeen[k] == stamp && t >= pf->vacate[k];
+}
+
+// wall-only BFS distances to the target; walls are static between respawns,
+// so this only reruns when the target or the wall layer changes
+static void update_field(PathFinder *pf, const Board *board, int target) {
+    if (pf->fieldBoard == board && pf->fieldVersion == board->version[LAYER_WALL] && pf->fieldTarget == target) return;
+    pf->fieldBoard = board; pf->fieldVersion = board->version[LAYER_WALL]; pf->fieldTarget = target;
+
+    unsigned stamp = next_stamp(pf);
+    int qh = 0, qt = 0;
+    pf->queue[qt++] = target; pf->seen[target] = stamp; pf->field[target] = 0;
+    while (qh < qt) {
+        int cur = pf->queue[qh++], cx = cur % pf->width, cy = cur / pf->width;
+        for (int d = 0; d < 4; d++) {
+            int nx = cx + dirs[d][0], ny = cy + dirs[d][1];
+            if (!board_in_bounds(board, nx, ny)) continue;
+            int k = ny * pf->width + nx;
+            if (pf->seen[k] == stamp || board_test(board, LAYER_WALL, nx, ny)) continue;
+            pf->seen[k] = stamp; pf->field[k] = pf->field[cur] + 1;
+            pf->queue[qt++] = k;
+        }
+    }
+    // cells the flood didn't reach keep stale values; mark them unreachable
+    for (int k = 0; k < pf->width * pf->height; k++) if (pf->seen[k] != stamp) pf->field[k] = -1;
+}
+
+static int dir_between(const PathFinder *pf, int from, int to) {
+    int d = to - from;
+    if (d == -pf->width) return 0;
+    if (d == 1) return 1;
+    if (d == pf->width) return 2;
+    return 3;
+}
+
+// The cached path stays valid from one tick to the next: the head has moved one
+// cell along it and every body cell is one move closer to being vacated. As
+// long as length + grow hasn't changed (nothing eaten on the way) no cell on it
+// can have become blocked, so it is only re-checked after the snake grew.
+static int follow_cached_path(PathFinder *pf, const Board *board, const Snake *snake, int grow,
+                              unsigned stamp, int *bodyBuilt, int head, int target, int forbidDir) {
+    if (pf->pathLen < 2 || pf->pathBoard != board || pf->pathVersion != board->version[LAYER_WALL] ||
+        pf->path[pf->pathLen - 1] != target) return -1;
+    if (pf->path[pf->pathPos] != head) {
+        if (pf->pathPos + 1 < pf->pathLen && pf->path[pf->pathPos + 1] == head) pf->pathPos++;
+        else return -1;
+    }
+    if (pf->pathPos + 1 >= pf->pathLen) return -1;
+    if (pf->pathReach != snake->length + grow) {
+        for (int j = pf->pathPos + 1, t = 1; j < pf->pathLen; j++, t++) {
+            if (!passable(pf, board, snake, grow, stamp, bodyBuilt, pf->path[j], t)) return -1;
+        }
+        pf->pathReach = snake->length + grow;
+    }
+    int d = dir_between(pf, head, pf->path[pf->pathPos + 1]);
+    return d == forbidDir ? -1 : d;
+}
+
+static void keep_path(PathFinder *pf, const Board *board, const Snake *snake, int grow, int len) {
+    pf->pathLen = len; pf->pathPos = 0; pf->pathReach = snake->length + grow;
+    pf->pathBoard = board; pf->pathVersion = board->version[LAYER_WALL];
+}
+
+// Open-board fast path: a monotone walk towards the target is a shortest path
+// if nothing blocks it, and costs only its own length rather than a flood of
+// the board. Steps along the axis with more distance left first. Returns the
+// path length in moves, or -1 if the walk got stuck.
+static int monotone_path(PathFinder *pf, const Board *board, const Snake *snake, int grow, unsigned stamp,
+                         int *bodyBuilt, int sx, int sy, int tx, int ty, int forbidDir) {
+    int x = sx, y = sy, t = 0;
+    pf->path[0] = sy * pf->width + sx;
+    while (x != tx || y != ty) {
+        int hd = tx > x ? 1 : 3, vd = ty > y ? 2 : 0;
+        int dx = abs(tx - x), dy = abs(ty - y);
+        int order[2] = { dx >= dy ? hd : vd, dx >= dy ? vd : hd };
+        int moved = 0;
+        t++;
+        for (int o = 0; o < 2 && !moved; o++) {
+            int d = order[o];
+            if ((d & 1 ? dx : dy) == 0 || (t == 1 && d == forbidDir)) continue;
+            int nx = x + dirs[d][0], ny = y + dirs[d][1], k = ny * pf->width + nx;
+            if (!passable(pf, board, snake, grow, stamp, bodyBuilt, k, t)) continue;
+            x = nx; y = ny; pf->path[t] = k; moved = 1;
+        }
+        if (!moved) return -1;
+    }
+    return t;
+}
+
+// Returns 1 and the first move (0 up,1 right,2 down,3 left) of a shortest
+// body-safe path to the target. If the target can't be reached it still
+// returns 1 with the safe move that keeps the most cells reachable, and 0 only
+// when every move is fatal. `forbidDir` (the reversal) is never chosen.
+int find_path_to_target(PathFinder *pf, const Board *board, const Snake *snake, int grow,
+                        int forbidDir, int tx, int ty, int *outDir) {
+    int sx = snake_head_x(snake), sy = snake_head_y(snake);
+    if (!board_in_bounds(board, sx, sy) || !board_in_bounds(board, tx, ty)) return 0;
+    int target = ty * pf->width + tx;
+    unsigned stamp = next_stamp(pf);
+    int bodyBuilt = 0, head = sy * pf->width + sx;
+
+    int cached = follow_cached_path(pf, board, snake, grow, stamp, &bodyBuilt, head, target, forbidDir);
+    if (cached >= 0) { *outDir = cached; return 1; }
+
+    int len = head == target ? -1 : monotone_path(pf, board, snake, grow, stamp, &bodyBuilt, sx, sy, tx, ty, forbidDir);
+    if (len > 0) {
+        keep_path(pf, board, snake, grow, len + 1);
+        *outDir = dir_between(pf, head, pf->path[1]);
+        return 1;
+    }
+
+    // the field flood reuses the stamp arrays, so take a fresh stamp after it
+    update_field(pf, board, target);
+    stamp = next_stamp(pf); bodyBuilt = 0;
+
+    // fast path: walk straight down the cached wall field; if no body segment is
+    // still in the way when we get there, that is already a shortest safe path
+    if (pf->field[head] > 0) {
+        int x = sx, y = sy, firstDir = -1;
+        pf->path[0] = head;
+        for (int t = 1; ; t++) {
+            int want = pf->field[y * pf->width + x] - 1, moved = 0;
+            for (int d = 0; d < 4 && !moved; d++) {
+                if (t == 1 && d == forbidDir) continue;
+                int nx = x + dirs[d][0], ny = y + dirs[d][1];
+                if (!board_in_bounds(board, nx, ny) || pf->field[ny * pf->width + nx] != want) continue;
+                if (!passable(pf, board, snake, grow, stamp, &bodyBuilt, ny * pf->width + nx, t)) continue;
+                if (t == 1) firstDir = d;
+                x = nx; y = ny; moved = 1;
+                pf->path[t] = ny * pf->width + nx;
+            }
+            if (!moved) break;
+            if (want == 0) { keep_path(pf, board, snake, grow, t + 1); *outDir = firstDir; return 1; }
+        }
+    }
+
+    // time-indexed BFS from the head: a body cell becomes enterable once the
+    // tail will have left it by the time we arrive
+    int qh = 0, qt = 0, reached[4] = {0, 0, 0, 0};
+    pf->queue[qt++] = head; pf->seen[head] = stamp; pf->dist[head] = 0;
+    while (qh < qt) {
+        int cur = pf->queue[qh++], cx = cur % pf->width, cy = cur / pf->width, t = pf->dist[cur] + 1;
+        for (int d = 0; d < 4; d++) {
+            if (qh == 1 && d == forbidDir) continue;
+            int nx = cx + dirs[d][0], ny = cy + dirs[d][1];
+            if (!board_in_bounds(board, nx, ny)) continue;
+            int k = ny * pf->width + nx;
+            if (pf->seen[k] == stamp) continue;
+            if (!passable(pf, board, snake, grow, stamp, &bodyBuilt, k, t)) continue;
+            pf->seen[k] = stamp; pf->dist[k] = t; pf->parent[k] = cur;
+            pf->first[k] = (unsigned char)(qh == 1 ? d : pf->first[cur]);
+            if (k == target) {
+                for (int j = t, c = k; j >= 0; j--, c = pf->parent[c]) pf->path[j] = c;
+                keep_path(pf, board, snake, grow, t + 1);
+                *outDir = pf->first[k];
+                return 1;
+            }
+            reached[pf->first[k]]++;
+            pf->queue[qt++] = k;
+        }
+    }
+
+    // target cut off: head for the most open space
+    pf->pathLen = 0;
+    int best = -1;
+    for (int d = 0; d < 4; d++) if (reached[d] > 0 && (best < 0 || reached[d] > reached[best])) best = d;
+    if (best < 0) return 0;
+    *outDir = best;
+    return 1;
+}
@@ -0,0 +1,42 @@
+#ifndef PATH_H
+#define PATH_H
+
+#include "board.h"
+#include "snake.h"
+
+// Reusable pathfinding engine: all scratch is allocated once in path_init and
+// invalidated by bumping a stamp, so a decision does no allocation or clearing.
+// Walls are looked up on the board's bit layer; body cells are obstacles only
+// until the move at which the tail will have pulled out of them.
+typedef struct PathFinder {
+    int width, height;
+    unsigned stamp;
+    unsigned *seen;           // BFS visit stamp per cell
+    unsigned *bodySeen;       // stamp marking cells of `vacate` filled this call
+    int *vacate;              // moves until a body cell is free
+    int *queue;
+    int *dist;
+    int *parent;
+    unsigned char *first;     // first move on the path to each reached cell
+
+    // last path found (cell indices, head first); re-validated and followed
+    // on the next call instead of searching again
+    int *path;
+    int pathLen, pathPos;
+    int pathReach;            // snake length + grow when the path was last checked
+    const Board *pathBoard;
+    unsigned pathVersion;
+
+    // wall-only distance field to the current target, cached per layout
+    int *field;
+    const Board *fieldBoard;
+    unsigned fieldVersion;
+    int fieldTarget;
+} PathFinder;
+
+int path_init(PathFinder *pf, int width, int height);
+void path_free(PathFinder *pf);
+int find_path_to_target(PathFinder *pf, const Board *board, const Snake *snake, int grow,
+                        int forbidDir, int tx, int ty, int *outDir);
+
+#endif
@@ -0,0 +1,187 @@
+#include "profile.h"
+
+#ifdef PROFILE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+static const char *phaseNames[PROF_PHASES] = {
+    "frame", "input", "ai", "logic", "place", "occupancy", "leaderboard", "draw", "present",
+};
+static const char *milestoneNames[PROF_MILESTONES] = {
+    "first frame", "audio ready",
+};
+
+typedef struct {
+    int phase;
+    int64_t start, dur;     // ns since the first timing
+} TraceEvent;
+
+static struct {
+    int64_t origin;
+    int started;
+    int64_t open[PROF_PHASES];       // start of the running timing, per phase
+    int64_t frameTotal[PROF_PHASES]; // summed over the current frame
+    float window[PROF_PHASES][PROF_WINDOW];  // ms per frame, ring
+    float allocWindow[PROF_WINDOW];          // allocations per frame, ring
+    long long frameAllocs;                   // count at the start of the frame
+    int frames, pos;
+    TraceEvent events[PROF_EVENTS];  // ring of the most recent timings
+    long long eventCount;
+    int64_t milestone[PROF_MILESTONES];     // ns since the origin
+    int milestoneSet;                       // bit per milestone reached
+} prof;
+
+// only the thread that called prof_start records timings: the lookahead pool
+// runs game_step in its rollouts, and those must not touch the frame totals
+static __thread int profThread;
+
+// -------------------- allocation counting --------------------
+static long long allocCount;
+void *__real_malloc(size_t n);
+void *__real_calloc(size_t n, size_t m);
+void *__real_realloc(void *p, size_t n);
+static void count_alloc(void) { __atomic_fetch_add(&allocCount, 1, __ATOMIC_RELAXED); }
+void *__wrap_malloc(size_t n) { count_alloc(); return __real_malloc(n); }
+void *__wrap_calloc(size_t n, size_t m) { count_alloc(); return __real_calloc(n, m); }
+void *__wrap_realloc(void *p, size_t n) { count_alloc(); return __real_realloc(p, n); }
+
+long long prof_alloc_count(void) {
+    return __atomic_load_n(&allocCount, __ATOMIC_RELAXED);
+}
+
+// -------------------- timing --------------------
+static int64_t now_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER t;
+    if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t);
+    return (int64_t)((double)t.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+static int64_t since_origin(void) {
+    int64_t t = now_ns();
+    if (!prof.started) { prof.origin = t; prof.started = 1; }
+    return t - prof.origin;
+}
+
+void prof_begin(int phase) {
+    if (!profThread) return;
+    prof.open[phase] = since_origin();
+}
+
+void prof_end(int phase) {
+    if (!profThread) return;
+    int64_t t = since_origin(), dur = t - prof.open[phase];
+    prof.frameTotal[phase] += dur;
+    TraceEvent *e = &prof.events[prof.eventCount++ % PROF_EVENTS];
+    e->phase = phase; e->start = prof.open[phase]; e->dur = dur;
+}
+
+// close the frame that just ended, fold its totals into the window, open the next
+void prof_frame(void) {
+    if (prof.started) {
+        prof_end(PROF_FRAME);
+        for (int p = 0; p < PROF_PHASES; p++) {
+            prof.window[p][prof.pos] = (float)(prof.frameTotal[p] / 1e6);
+            prof.frameTotal[p] = 0;
+        }
+        prof.allocWindow[prof.pos] = (float)(prof_alloc_count() - prof.frameAllocs);
+        prof.pos = (prof.pos + 1) % PROF_WINDOW;
+        if (prof.frames < PROF_WINDOW) prof.frames++;
+    }
+    prof.frameAllocs = prof_alloc_count();
+    prof_begin(PROF_FRAME);
+}
+
+static int cmp_float(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+static int window_stats(const float *window, ProfStats *out) {
+    if (!prof.frames) return 0;
+    float v[PROF_WINDOW];
+    memcpy(v, window, sizeof(float) * prof.frames);
+    qsort(v, prof.frames, sizeof(float), cmp_float);
+    double sum = 0;
+    for (int i = 0; i < prof.frames; i++) sum += v[i];
+    out->min = v[0];
+    out->avg = sum / prof.frames;
+    out->p99 = v[(prof.frames - 1) * 99 / 100];
+    return 1;
+}
+
+// rolling stats of one phase; 0 until a frame has completed
+int prof_stats(int phase, ProfStats *out) {
+    return window_stats(prof.window[phase], out);
+}
+
+int prof_alloc_stats(ProfStats *out) {
+    return window_stats(prof.allocWindow, out);
+}
+
+const char *prof_name(int phase) {
+    return phaseNames[phase];
+}
+
+// -------------------- startup --------------------
+// pin the origin at program start so milestones measure time since launch,
+// and make the calling thread the one that records
+void prof_start(void) {
+    profThread = 1;
+    prof.started = 0;
+    since_origin();
+}
+
+// record a milestone the first time it is reached (main thread only)
+void prof_milestone(int m) {
+    if (prof.milestoneSet & (1 << m)) return;
+    prof.milestone[m] = since_origin();
+    prof.milestoneSet |= 1 << m;
+}
+
+// ms since launch, or -1 if not reached yet
+double prof_milestone_ms(int m) {
+    return prof.milestoneSet & (1 << m) ? prof.milestone[m] / 1e6 : -1;
+}
+
+const char *prof_milestone_name(int m) {
+    return milestoneNames[m];
+}
+
+// Chrome trace-event JSON of the retained events ("X" complete events, times in µs)
+int prof_export_trace(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return 0;
+    long long n = prof.eventCount < PROF_EVENTS ? prof.eventCount : PROF_EVENTS;
+    long long first = prof.eventCount - n;
+    fprintf(f, "{\"traceEvents\":[\n");
+    for (long long i = 0; i < n; i++) {
+        const TraceEvent *e = &prof.events[(first + i) % PROF_EVENTS];
+        fprintf(f, "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1},\n",
+                phaseNames[e->phase], e->start / 1e3, e->dur / 1e3);
+    }
+    // milestones as spans from launch, on their own track
+    for (int m = 0; m < PROF_MILESTONES; m++) {
+        if (!(prof.milestoneSet & (1 << m))) continue;
+        fprintf(f, "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":0,\"dur\":%.3f,\"pid\":1,\"tid\":2},\n",
+                milestoneNames[m], prof.milestone[m] / 1e3);
+    }
+    fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"startup\"}}\n");
+    fprintf(f, "],\"displayTimeUnit\":\"ms\"}\n");
+    return fclose(f) == 0;
+}
+#endif
@@ -0,0 +1,73 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+// Per-phase frame profiler. Build with -DPROFILE (make profile) to enable;
+// otherwise every PROF_* macro compiles to nothing and profile.c is empty.
+//
+// Phases are timed with PROF_BEGIN/PROF_END pairs on a monotonic clock and
+// summed per frame; PROF_FRAME() marks the frame boundary and folds the
+// totals into a rolling window of PROF_WINDOW frames for min/avg/p99. The
+// most recent PROF_EVENTS timings are also kept as trace events and can be
+// written out as Chrome trace-event JSON (chrome://tracing, Perfetto).
+// Heap allocations are counted per frame too when linked with
+// -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc.
+//
+// Startup is measured from PROF_START() at the top of main: milestones such
+// as the first presented frame are recorded once, in ms since then. Only the
+// thread that called PROF_START() records timings; PROF_BEGIN/PROF_END on any
+// other thread (the lookahead rollouts step games too) do nothing.
+
+enum {
+    PROF_FRAME = 0,     // boundary to boundary
+    PROF_INPUT,
+    PROF_AI,
+    PROF_LOGIC,         // game_step, including the placement and occupancy phases
+    PROF_PLACE,         // fruit placement
+    PROF_OCCUPANCY,     // occupancy consistency rebuild (debug builds)
+    PROF_LEADERBOARD,
+    PROF_DRAW,
+    PROF_PRESENT,       // EndDrawing: buffer swap and vsync wait
+    PROF_PHASES
+};
+
+enum {
+    PROF_FIRST_FRAME = 0,   // time to first frame: end of the first EndDrawing
+    PROF_AUDIO_READY,       // sounds attached after background loading
+    PROF_MILESTONES
+};
+
+#define PROF_WINDOW 240
+#define PROF_EVENTS 65536
+
+typedef struct {
+    double min, avg, p99;   // per-frame totals over the window, in ms (or allocations)
+} ProfStats;
+
+#ifdef PROFILE
+void prof_begin(int phase);
+void prof_end(int phase);
+void prof_frame(void);
+int prof_stats(int phase, ProfStats *out);
+int prof_alloc_stats(ProfStats *out);
+long long prof_alloc_count(void);
+const char *prof_name(int phase);
+void prof_start(void);
+void prof_milestone(int m);
+double prof_milestone_ms(int m);
+const char *prof_milestone_name(int m);
+int prof_export_trace(const char *path);
+
+#define PROF_BEGIN(p) prof_begin(p)
+#define PROF_END(p) prof_end(p)
+#define PROF_FRAME() prof_frame()
+#define PROF_START() prof_start()
+#define PROF_MILESTONE(m) prof_milestone(m)
+#else
+#define PROF_BEGIN(p) ((void)0)
+#define PROF_END(p) ((void)0)
+#define PROF_FRAME() ((void)0)
+#define PROF_START() ((void)0)
+#define PROF_MILESTONE(m) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,85 @@
+#include "render.h"
+#include <stdlib.h>
+#include <string.h>
+
+// above this many changed cells one whole-texture upload beats per-cell updates
+#define MAX_CELL_UPLOADS 64
+
+static const Color cellColors[] = {
+    [CELLVIEW_EMPTY] = {10, 10, 10, 255},
+    [CELLVIEW_WALL]  = {130, 130, 130, 255}, // GRAY
+    [CELLVIEW_SNAKE] = {0, 228, 48, 255},    // GREEN
+};
+
+int boardview_init(BoardView *v, int cols, int rows) {
+    int cells = cols * rows;
+    memset(v, 0, sizeof(*v));
+    v->cols = cols; v->rows = rows;
+    v->state = calloc(cells, 1);
+    v->pixels = malloc(sizeof(Color) * cells);
+    v->dirty = malloc(sizeof(int) * MAX_CELL_UPLOADS);
+    v->headCell = -1;
+    if (!v->state || !v->pixels || !v->dirty) { boardview_free(v); return 0; }
+    for (int i = 0; i < cells; i++) v->pixels[i] = cellColors[CELLVIEW_EMPTY];
+
+    Image img = { v->pixels, cols, rows, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    v->tex = LoadTextureFromImage(img);
+    SetTextureFilter(v->tex, TEXTURE_FILTER_POINT);
+    return 1;
+}
+
+static int cell_view(const Board *b, int x, int y, int headCell) {
+    if (!board_in_bounds(b, x, y)) return CELLVIEW_EMPTY;
+    int i = y * b->width + x;
+    uint64_t bit = (uint64_t)1 << (i & 63);
+    if (b->layer[LAYER_WALL][i >> 6] & bit) return CELLVIEW_WALL;
+    if ((b->layer[LAYER_SNAKE][i >> 6] & bit) && i != headCell) return CELLVIEW_SNAKE;
+    return CELLVIEW_EMPTY;
+}
+
+// Re-reads the visible cells when the walls, snake or camera changed since the
+// last call and uploads the ones that differ from what the texture shows.
+// `snake` may be NULL (arena): then every body cell, heads included, is drawn.
+void boardview_sync(BoardView *v, const Board *b, const Snake *snake, int originX, int originY) {
+    int headCell = -1;
+    if (snake) {
+        int hx = snake_head_x(snake), hy = snake_head_y(snake);
+        if (board_in_bounds(b, hx, hy)) headCell = hy * b->width + hx;
+    }
+    if (v->board == b && v->seen[0] == b->version[LAYER_WALL] && v->seen[1] == b->version[LAYER_SNAKE] &&
+        v->headCell == headCell && v->originX == originX && v->originY == originY) return;
+    v->board = b; v->seen[0] = b->version[LAYER_WALL]; v->seen[1] = b->version[LAYER_SNAKE];
+    v->headCell = headCell; v->originX = originX; v->originY = originY;
+
+    int nDirty = 0, overflow = 0;
+    for (int r = 0; r < v->rows; r++) {
+        for (int c = 0; c < v->cols; c++) {
+            int i = r * v->cols + c, s = cell_view(b, originX + c, originY + r, headCell);
+            if (s == v->state[i]) continue;
+            v->state[i] = (unsigned char)s;
+            v->pixels[i] = cellColors[s];
+            if (nDirty < MAX_CELL_UPLOADS) v->dirty[nDirty++] = i;
+            else overflow = 1;
+        }
+    }
+
+    if (overflow) UpdateTexture(v->tex, v->pixels);
+    else for (int k = 0; k < nDirty; k++) {
+        int i = v->dirty[k];
+        UpdateTextureRec(v->tex, (Rectangle){ (float)(i % v->cols), (float)(i / v->cols), 1, 1 }, &v->pixels[i]);
+    }
+}
+
+// draws in board coordinates (cell * cellSize); pair with a Camera2D to scroll
+void boardview_draw(const BoardView *v, int cellSize) {
+    Rectangle src = { 0, 0, (float)v->cols, (float)v->rows };
+    Rectangle dst = { (float)(v->originX * cellSize), (float)(v->originY * cellSize),
+                      (float)(v->cols * cellSize), (float)(v->rows * cellSize) };
+    DrawTexturePro(v->tex, src, dst, (Vector2){ 0, 0 }, 0.0f, WHITE);
+}
+
+void boardview_free(BoardView *v) {
+    if (v->tex.id) UnloadTexture(v->tex);
+    free(v->state); free(v->pixels); free(v->dirty);
+    memset(v, 0, sizeof(*v));
+}
@@ -0,0 +1,32 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "raylib.h"
+#include "board.h"
+#include "snake.h"
+
+// What a board cell shows in the batched texture
+enum { CELLVIEW_EMPTY = 0, CELLVIEW_WALL, CELLVIEW_SNAKE };
+
+// Visible window of the board rendered as a texture with one pixel per cell,
+// drawn scaled in a single call. The texture covers only the viewport, so its
+// cost follows the window size, not the board size. Cells are re-uploaded
+// only when they change; the head is left out so it can be drawn interpolated.
+typedef struct BoardView {
+    int cols, rows;           // viewport size in cells
+    int originX, originY;     // board cell shown at the top-left of the viewport
+    unsigned char *state;     // CELLVIEW_* last uploaded per viewport cell
+    Color *pixels;            // CPU copy of the texture
+    int *dirty;               // scratch list of changed viewport cells
+    const Board *board;       // board and layer versions as of the last sync
+    unsigned seen[2];
+    int headCell;
+    Texture2D tex;
+} BoardView;
+
+int boardview_init(BoardView *v, int cols, int rows);
+void boardview_sync(BoardView *v, const Board *b, const Snake *snake, int originX, int originY);
+void boardview_draw(const BoardView *v, int cellSize);
+void boardview_free(BoardView *v);
+
+#endif
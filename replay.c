@@ -0,0 +1,186 @@
+#include "replay.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// sanity cap on one record's encoded runs (~ a year of ticks at worst)
+#define MAX_RUN_BYTES (64u << 20)
+// runs reserved up front so recording a typical game never allocates mid-game
+#define REPLAY_RESERVE 4096
+
+// -------------------- recording --------------------
+// start an empty recording; keeps the run buffer of a previous one
+void replay_start(Replay *r, uint64_t seed, int width, int height, int difficulty, int layout) {
+    r->seed = seed;
+    r->width = width; r->height = height; r->difficulty = difficulty; r->layout = layout;
+    r->score = 0; r->ticks = 0; r->timestamp = 0;
+    r->name[0] = '\0';
+    r->runCount = 0;
+    if (r->runCap < REPLAY_RESERVE) {
+        ReplayRun *p = realloc(r->runs, sizeof(ReplayRun) * REPLAY_RESERVE);
+        if (p) { r->runs = p; r->runCap = REPLAY_RESERVE; }
+    }
+}
+
+// log the action passed to one game_step; returns 0 if out of memory
+int replay_record(Replay *r, int action) {
+    uint8_t a = (uint8_t)(action >= 0 && action < 4 ? action + 1 : 0);
+    r->ticks++;
+    if (r->runCount && r->runs[r->runCount - 1].action == a && r->runs[r->runCount - 1].count < UINT32_MAX) {
+        r->runs[r->runCount - 1].count++;
+        return 1;
+    }
+    if (r->runCount == r->runCap) {
+        int cap = r->runCap ? r->runCap * 2 : 256;
+        ReplayRun *p = realloc(r->runs, sizeof(ReplayRun) * cap);
+        if (!p) return 0;
+        r->runs = p; r->runCap = cap;
+    }
+    r->runs[r->runCount++] = (ReplayRun){ a, 1 };
+    return 1;
+}
+
+// -------------------- file format --------------------
+static uint32_t fnv1a(uint32_t h, const void *data, size_t n) {
+    const unsigned char *p = data;
+    for (size_t i = 0; i < n; i++) { h ^= p[i]; h *= 16777619u; }
+    return h;
+}
+
+static uint32_t record_checksum(const ReplayHeader *h, const unsigned char *runs) {
+    ReplayHeader tmp = *h;
+    tmp.checksum = 0;
+    return fnv1a(fnv1a(2166136261u, &tmp, sizeof(tmp)), runs, h->runBytes);
+}
+
+static size_t encode_runs(const Replay *r, unsigned char *out) {
+    size_t n = 0;
+    for (int i = 0; i < r->runCount; i++) {
+        out[n++] = r->runs[i].action;
+        uint32_t c = r->runs[i].count;
+        while (c >= 0x80) { out[n++] = (unsigned char)(c | 0x80); c >>= 7; }
+        out[n++] = (unsigned char)c;
+    }
+    return n;
+}
+
+static int decode_runs(Replay *r, const unsigned char *p, size_t len) {
+    size_t i = 0;
+    r->runCount = 0; r->ticks = 0;
+    while (i < len) {
+        uint8_t a = p[i++];
+        uint32_t c = 0;
+        for (int shift = 0; ; shift += 7) {
+            if (i >= len || shift > 28) return 0;
+            c |= (uint32_t)(p[i] & 0x7F) << shift;
+            if (!(p[i++] & 0x80)) break;
+        }
+        if (a > 4 || c == 0) return 0;
+        if (r->runCount == r->runCap) {
+            int cap = r->runCap ? r->runCap * 2 : 256;
+            ReplayRun *q = realloc(r->runs, sizeof(ReplayRun) * cap);
+            if (!q) return 0;
+            r->runs = q; r->runCap = cap;
+        }
+        r->runs[r->runCount++] = (ReplayRun){ a, c };
+        r->ticks += (int)c;
+    }
+    return 1;
+}
+
+// Write one record for the recording as it stands (name, score and timestamp
+// included). Returns 1 on success.
+int replay_write(FILE *f, const Replay *r) {
+    size_t n = strlen(r->name);
+    if (n > MAX_NAME_LEN - 1) n = MAX_NAME_LEN - 1;
+    unsigned char *runs = malloc((size_t)r->runCount * 6 + 1); // action byte + up to 5 count bytes
+    if (!runs) return 0;
+    ReplayHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = REPLAY_MAGIC; h.version = REPLAY_VERSION;
+    h.seed = r->seed; h.timestamp = r->timestamp;
+    h.width = r->width; h.height = r->height; h.difficulty = r->difficulty;
+    h.score = r->score; h.ticks = r->ticks;
+    h.runBytes = (uint32_t)encode_runs(r, runs);
+    h.nameLen = (uint8_t)n;
+    memcpy(h.name, r->name, n);
+    h.layout = (uint8_t)r->layout;
+    h.checksum = record_checksum(&h, runs);
+
+    int ok = fwrite(&h, sizeof(h), 1, f) == 1 && fwrite(runs, 1, h.runBytes, f) == h.runBytes;
+    free(runs);
+    return ok;
+}
+
+int replay_append(Replay *r, const char *path, const char *name, int score) {
+    size_t n = strlen(name);
+    if (n > MAX_NAME_LEN - 1) n = MAX_NAME_LEN - 1;
+    memcpy(r->name, name, n); r->name[n] = '\0';
+    r->score = score;
+    r->timestamp = (long long)time(NULL);
+
+    FILE *f = fopen(path, "ab");
+    int ok = f && replay_write(f, r);
+    if (f && fclose(f) != 0) ok = 0;
+    return ok;
+}
+
+// Read the next record of a replay log. Returns 1 on success, -1 for a
+// damaged record that was skipped (reading can go on), and 0 at the end of
+// the log or when the framing is lost.
+int replay_read(FILE *f, Replay *r) {
+    ReplayHeader h;
+    if (fread(&h, sizeof(h), 1, f) != 1) return 0;
+    if (h.magic != REPLAY_MAGIC || h.version != REPLAY_VERSION || h.runBytes > MAX_RUN_BYTES) return 0;
+    unsigned char *runs = malloc(h.runBytes ? h.runBytes : 1);
+    if (!runs) return 0;
+    if (fread(runs, 1, h.runBytes, f) != h.runBytes) { free(runs); return 0; }
+
+    int ok = h.checksum == record_checksum(&h, runs) && h.nameLen < MAX_NAME_LEN &&
+             decode_runs(r, runs, h.runBytes) && r->ticks == h.ticks;
+    free(runs);
+    if (!ok) return -1;
+    r->seed = h.seed; r->timestamp = h.timestamp;
+    r->width = h.width; r->height = h.height; r->difficulty = h.difficulty; r->layout = h.layout;
+    r->score = h.score;
+    memcpy(r->name, h.name, h.nameLen); r->name[h.nameLen] = '\0';
+    return 1;
+}
+
+void replay_free(Replay *r) {
+    free(r->runs);
+    r->runs = NULL;
+    r->runCount = r->runCap = 0;
+}
+
+// -------------------- playback --------------------
+// set up the game exactly as it was when recording began
+int replay_game_init(const Replay *r, GameState *g, ReplayCursor *c) {
+    c->r = r; c->run = 0; c->used = 0;
+    return game_init_layout(g, r->width, r->height, r->seed, r->difficulty, r->layout);
+}
+
+// next recorded action; ACTION_NONE once the recording is exhausted
+int replay_next(ReplayCursor *c) {
+    if (replay_done(c)) return ACTION_NONE;
+    const ReplayRun *run = &c->r->runs[c->run];
+    if (++c->used == run->count) { c->run++; c->used = 0; }
+    return run->action ? run->action - 1 : ACTION_NONE;
+}
+
+// Re-simulate the whole recording as fast as possible. Returns 1 if it
+// reproduces the claimed score and length, 0 if not, -1 if it can't be set up.
+int replay_run(const Replay *r, int *outScore, int *outTicks) {
+    GameState g;
+    ReplayCursor c;
+    if (!replay_game_init(r, &g, &c)) return -1;
+    int ticks = 0;
+    for (int i = 0; i < c.r->runCount && !g.gameOver; i++) {
+        int action = r->runs[i].action ? r->runs[i].action - 1 : ACTION_NONE;
+        for (uint32_t k = 0; k < r->runs[i].count; k++, ticks++) game_step(&g, action);
+    }
+    *outScore = g.score;
+    *outTicks = ticks;
+    game_free(&g);
+    return *outScore == r->score && ticks == r->ticks;
+}
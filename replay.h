@@ -0,0 +1,70 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "game.h"
+#include "scoreindex.h"
+
+// A game is fully determined by its seed, board size, difficulty, layout and the
+// action passed to each game_step, so that is all a replay stores. Actions
+// are run-length encoded: (action, count) runs, written as one action byte
+// (0 = none, 1..4 = direction + 1) and a LEB128 count.
+//
+// Replay files are append-only logs of records: a fixed header followed by
+// `runBytes` of encoded runs, checksummed together.
+#define REPLAY_MAGIC 0x50524E53u   // "SNRP"
+#define REPLAY_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t seed;
+    int64_t timestamp;
+    int32_t width, height, difficulty;
+    int32_t score;             // outcome claimed when saved
+    int32_t ticks;             // game_step calls recorded
+    uint32_t runBytes;
+    uint32_t checksum;         // FNV-1a over header (this field zeroed) and runs
+    uint8_t nameLen;
+    char name[MAX_NAME_LEN];   // not NUL-terminated on disk
+    uint8_t layout;            // LAYOUT_*
+    uint8_t reserved[4];
+} ReplayHeader;
+
+typedef struct {
+    uint8_t action;            // 0 = none, 1..4 = direction + 1
+    uint32_t count;
+} ReplayRun;
+
+typedef struct Replay {
+    uint64_t seed;
+    int width, height, difficulty, layout;
+    int score, ticks;
+    long long timestamp;
+    char name[MAX_NAME_LEN];
+    ReplayRun *runs;
+    int runCount, runCap;
+} Replay;
+
+// playback position in a replay
+typedef struct {
+    const Replay *r;
+    int run;
+    uint32_t used;             // actions taken from the current run
+} ReplayCursor;
+
+void replay_start(Replay *r, uint64_t seed, int width, int height, int difficulty, int layout);
+int replay_record(Replay *r, int action);
+int replay_append(Replay *r, const char *path, const char *name, int score);
+int replay_write(FILE *f, const Replay *r);
+int replay_read(FILE *f, Replay *r);
+int replay_run(const Replay *r, int *outScore, int *outTicks);
+void replay_free(Replay *r);
+
+int replay_game_init(const Replay *r, GameState *g, ReplayCursor *c);
+int replay_next(ReplayCursor *c);
+
+static inline int replay_done(const ReplayCursor *c) { return c->run >= c->r->runCount; }
+
+#endif
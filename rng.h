@@ -0,0 +1,29 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// Small per-game PRNG (xorshift64*, seeded through splitmix64) so a game is
+// fully determined by its seed, independent of the C library's rand().
+typedef struct Rng {
+    uint64_t s;
+} Rng;
+
+static inline void rng_seed(Rng *r, uint64_t seed) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    r->s = (z ^ (z >> 31)) | 1; // never zero
+}
+
+static inline uint32_t rng_next(Rng *r) {
+    r->s ^= r->s >> 12; r->s ^= r->s << 25; r->s ^= r->s >> 27;
+    return (uint32_t)((r->s * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+// uniform in [0, n) (Lemire's multiply-shift; bias is below 2^-32 * n)
+static inline int rng_below(Rng *r, int n) {
+    return (int)(((uint64_t)rng_next(r) * (uint32_t)n) >> 32);
+}
+
+#endif
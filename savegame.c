@@ -0,0 +1,157 @@
+#include "savegame.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint32_t fnv1a(uint32_t h, const void *data, size_t n) {
+    const unsigned char *p = data;
+    for (size_t i = 0; i < n; i++) { h ^= p[i]; h *= 16777619u; }
+    return h;
+}
+
+static uint32_t save_checksum(const SaveHeader *h, const unsigned char *state) {
+    SaveHeader tmp = *h;
+    tmp.checksum = 0;
+    return fnv1a(fnv1a(2166136261u, &tmp, sizeof(tmp)), state, h->stateBytes);
+}
+
+static size_t state_bytes(const Board *b, int snakeLength, int wallCount, int freeCount) {
+    return sizeof(SaveState) + sizeof(Cell) * ((size_t)snakeLength + wallCount) +
+           sizeof(uint64_t) * (size_t)b->words * LAYER_COUNT + sizeof(int32_t) * (size_t)freeCount;
+}
+
+static void put_fruit(int32_t *out, const Fruit *f) {
+    out[0] = f->x; out[1] = f->y; out[2] = f->active; out[3] = f->expires;
+}
+static void get_fruit(Fruit *f, const int32_t *in) {
+    f->x = in[0]; f->y = in[1]; f->active = in[2]; f->expires = in[3];
+}
+
+// -------------------- save --------------------
+// Write the game and its recording so far to `path` (replacing it). The
+// record carries the current score, so a save can be checked like a replay.
+int game_save(const GameState *g, const Replay *r, const char *path) {
+    const Board *b = &g->board;
+    const Snake *snake = &g->snake;
+    size_t bytes = state_bytes(b, snake->length, g->wallCount, b->freeCount);
+    unsigned char *state = malloc(bytes);
+    if (!state) return 0;
+
+    SaveState s;
+    memset(&s, 0, sizeof(s));
+    s.rng = g->rng.s;
+    s.layout = g->layout; s.difficulty = g->difficulty; s.speed = g->speed; s.multiplier = g->multiplier;
+    s.lives = g->lives; s.score = g->score; s.fruitsEaten = g->fruitsEaten; s.grow = g->grow;
+    s.gameOver = g->gameOver;
+    s.slowMode = g->slowMode; s.slowEnds = g->slowEnds; s.lastMoveDir = g->lastMoveDir;
+    s.lastDeath = g->lastDeath; s.tick = g->tick;
+    put_fruit(s.fruit[0], &g->food);
+    for (int i = 0; i < POWERUPS; i++) put_fruit(s.fruit[1 + i], &g->powerup[i]);
+    s.snakeLength = snake->length; s.snakeDirection = snake->direction; s.snakeBitten = snake->bitten;
+    s.wallCount = g->wallCount; s.freeCount = b->freeCount;
+
+    unsigned char *p = state;
+    memcpy(p, &s, sizeof(s)); p += sizeof(s);
+    for (int i = 0; i < snake->length; i++) {
+        Cell c = snake_segment(snake, i);
+        memcpy(p, &c, sizeof(c)); p += sizeof(c);
+    }
+    memcpy(p, g->walls, sizeof(Cell) * g->wallCount); p += sizeof(Cell) * g->wallCount;
+    memcpy(p, b->layer[0], sizeof(uint64_t) * b->words * LAYER_COUNT); p += sizeof(uint64_t) * b->words * LAYER_COUNT;
+    for (int i = 0; i < b->freeCount; i++) {
+        int32_t k = b->freeCells[i];
+        memcpy(p, &k, sizeof(k)); p += sizeof(k);
+    }
+
+    SaveHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = SAVE_MAGIC; h.version = SAVE_VERSION;
+    h.width = b->width; h.height = b->height;
+    h.stateBytes = (uint32_t)bytes;
+    h.checksum = save_checksum(&h, state);
+
+    Replay rec = *r;
+    rec.score = g->score;
+    rec.timestamp = (long long)time(NULL);
+
+    FILE *f = fopen(path, "wb");
+    int ok = f && fwrite(&h, sizeof(h), 1, f) == 1 && fwrite(state, 1, bytes, f) == bytes && replay_write(f, &rec);
+    if (f && fclose(f) != 0) ok = 0;
+    free(state);
+    return ok;
+}
+
+// -------------------- load --------------------
+// Fill `t` (a game of the save's size) from a checked payload; 0 if the
+// fields don't describe a consistent game.
+static int unpack(GameState *t, const unsigned char *state, size_t bytes) {
+    Board *b = &t->board;
+    int cells = b->width * b->height;
+    SaveState s;
+    memcpy(&s, state, sizeof(s));
+    if (s.snakeLength < 1 || s.snakeLength > t->snake.capacity || s.wallCount < 0 || s.wallCount > cells ||
+        s.freeCount < 0 || s.freeCount > cells || s.difficulty < 1 || s.difficulty > 3 ||
+        s.layout < 0 || s.layout >= LAYOUTS || s.speed < 1 || s.snakeDirection < 0 || s.snakeDirection > 3 ||
+        bytes != state_bytes(b, s.snakeLength, s.wallCount, s.freeCount)) return 0;
+
+    t->rng.s = s.rng;
+    t->layout = s.layout; t->difficulty = s.difficulty; t->speed = s.speed; t->multiplier = s.multiplier;
+    t->lives = s.lives; t->score = s.score; t->fruitsEaten = s.fruitsEaten; t->grow = s.grow;
+    t->gameOver = s.gameOver;
+    t->slowMode = s.slowMode; t->slowEnds = s.slowEnds; t->lastMoveDir = s.lastMoveDir;
+    t->lastDeath = s.lastDeath; t->tick = s.tick;
+    get_fruit(&t->food, s.fruit[0]);
+    for (int i = 0; i < POWERUPS; i++) get_fruit(&t->powerup[i], s.fruit[1 + i]);
+    game_arm_timers(t);
+
+    const unsigned char *p = state + sizeof(s);
+    t->snake.head = 0;
+    t->snake.length = s.snakeLength;
+    t->snake.direction = s.snakeDirection;
+    t->snake.bitten = s.snakeBitten;
+    memcpy(t->snake.body, p, sizeof(Cell) * s.snakeLength); p += sizeof(Cell) * s.snakeLength;
+    t->wallCount = s.wallCount;
+    memcpy(t->walls, p, sizeof(Cell) * s.wallCount); p += sizeof(Cell) * s.wallCount;
+    memcpy(b->layer[0], p, sizeof(uint64_t) * b->words * LAYER_COUNT); p += sizeof(uint64_t) * b->words * LAYER_COUNT;
+
+    for (int i = 0; i < cells; i++) b->freeIndex[i] = -1;
+    b->freeCount = s.freeCount;
+    for (int i = 0; i < s.freeCount; i++) {
+        int32_t k;
+        memcpy(&k, p, sizeof(k)); p += sizeof(k);
+        if (k < 0 || k >= cells || b->freeIndex[k] != -1) return 0;
+        b->freeCells[i] = k; b->freeIndex[k] = i;
+    }
+    for (int l = 0; l < LAYER_COUNT; l++) b->version[l]++;
+    return board_check_free(b);
+}
+
+// Resume the game saved in `path` into `g`, which must hold a game of the
+// same board size, and replace `r` with the recording saved with it. Nothing
+// is changed unless the whole file checks out.
+int game_load(GameState *g, Replay *r, const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return 0;
+    SaveHeader h;
+    unsigned char *state = NULL;
+    GameState t;
+    Replay rec;
+    memset(&t, 0, sizeof(t));
+    memset(&rec, 0, sizeof(rec));
+    int ok = fread(&h, sizeof(h), 1, f) == 1 && h.magic == SAVE_MAGIC && h.version == SAVE_VERSION &&
+             h.width == g->board.width && h.height == g->board.height && h.stateBytes >= sizeof(SaveState) &&
+             h.stateBytes <= state_bytes(&g->board, g->snake.capacity, g->board.width * g->board.height,
+                                         g->board.width * g->board.height);
+    ok = ok && (state = malloc(h.stateBytes)) && fread(state, 1, h.stateBytes, f) == h.stateBytes &&
+         h.checksum == save_checksum(&h, state);
+    ok = ok && replay_read(f, &rec) == 1 && rec.width == h.width && rec.height == h.height;
+    ok = ok && game_clone(&t, g) && unpack(&t, state, h.stateBytes) && rec.ticks == t.tick &&
+         rec.difficulty == t.difficulty && rec.layout == t.layout;
+    if (ok) ok = game_clone(g, &t);
+    if (ok) { replay_free(r); *r = rec; }
+    else replay_free(&rec);
+    game_free(&t);
+    free(state);
+    fclose(f);
+    return ok;
+}
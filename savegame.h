@@ -0,0 +1,39 @@
+#ifndef SAVEGAME_H
+#define SAVEGAME_H
+
+#include <stdint.h>
+#include "game.h"
+#include "replay.h"
+
+// Save/resume. A save file is a header, the game state as fixed-width fields
+// (never the in-memory GameState, whose layout and pointers are not a file
+// format) and a replay record of the game so far, so a resumed game carries
+// on recording and its final score still verifies from the seed.
+//
+// The state payload is a SaveState followed by the snake's cells from the
+// head, the wall list, the board's layer bits and its free-cell set.
+#define SAVE_MAGIC 0x56534E53u     // "SNSV"
+#define SAVE_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int32_t width, height;
+    uint32_t stateBytes;       // payload between this header and the replay record
+    uint32_t checksum;         // FNV-1a over header (this field zeroed) and payload
+} SaveHeader;
+
+typedef struct {
+    uint64_t rng;
+    int32_t layout, difficulty, speed, multiplier;
+    int32_t lives, score, fruitsEaten, grow, gameOver;
+    int32_t slowMode, slowEnds, lastMoveDir, lastDeath, tick;
+    int32_t fruit[1 + POWERUPS][4]; // food, then each power-up: x, y, active, expires
+    int32_t snakeLength, snakeDirection, snakeBitten;
+    int32_t wallCount, freeCount;
+} SaveState;
+
+int game_save(const GameState *g, const Replay *r, const char *path);
+int game_load(GameState *g, Replay *r, const char *path);
+
+#endif
@@ -0,0 +1,179 @@
+#include "scoreindex.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define NODE(ix, i) (&(ix)->pool[i])
+#define SIZE(ix, i) ((i) < 0 ? 0 : (ix)->pool[i].size)
+#define HEIGHT(ix, i) ((i) < 0 ? 0 : (ix)->pool[i].height)
+
+void scoreindex_init(ScoreIndex *ix) {
+    memset(ix, 0, sizeof(*ix));
+    ix->root = -1;
+}
+
+// drop every entry but keep the pool and table memory for the next load
+void scoreindex_reset(ScoreIndex *ix) {
+    ix->count = 0;
+    ix->root = -1;
+    if (ix->best) memset(ix->best, -1, sizeof(int) * ix->bestCap);
+    ix->bestCount = 0;
+}
+
+void scoreindex_free(ScoreIndex *ix) {
+    free(ix->pool);
+    free(ix->best);
+    scoreindex_init(ix);
+}
+
+// -------------------- AVL internals --------------------
+static void update(ScoreIndex *ix, int i) {
+    ScoreNode *n = NODE(ix, i);
+    int hl = HEIGHT(ix, n->left), hr = HEIGHT(ix, n->right);
+    n->height = (hl > hr ? hl : hr) + 1;
+    n->size = SIZE(ix, n->left) + SIZE(ix, n->right) + 1;
+}
+
+static int rotate_right(ScoreIndex *ix, int i) {
+    int l = NODE(ix, i)->left;
+    NODE(ix, i)->left = NODE(ix, l)->right; NODE(ix, l)->right = i;
+    update(ix, i); update(ix, l);
+    return l;
+}
+
+static int rotate_left(ScoreIndex *ix, int i) {
+    int r = NODE(ix, i)->right;
+    NODE(ix, i)->right = NODE(ix, r)->left; NODE(ix, r)->left = i;
+    update(ix, i); update(ix, r);
+    return r;
+}
+
+static int rebalance(ScoreIndex *ix, int i) {
+    update(ix, i);
+    ScoreNode *n = NODE(ix, i);
+    int bal = HEIGHT(ix, n->left) - HEIGHT(ix, n->right);
+    if (bal > 1) {
+        int l = n->left;
+        if (HEIGHT(ix, NODE(ix, l)->left) < HEIGHT(ix, NODE(ix, l)->right)) NODE(ix, i)->left = rotate_left(ix, l);
+        return rotate_right(ix, i);
+    }
+    if (bal < -1) {
+        int r = n->right;
+        if (HEIGHT(ix, NODE(ix, r)->right) < HEIGHT(ix, NODE(ix, r)->left)) NODE(ix, i)->right = rotate_right(ix, r);
+        return rotate_left(ix, i);
+    }
+    return i;
+}
+
+// recursion depth is bounded by the AVL height (~1.44 log2 n)
+static int avl_insert(ScoreIndex *ix, int root, int n) {
+    if (root < 0) return n;
+    const ScoreNode *a = NODE(ix, n), *b = NODE(ix, root);
+    int before = a->score > b->score || (a->score == b->score && a->seq < b->seq);
+    if (before) { int c = avl_insert(ix, NODE(ix, root)->left, n); NODE(ix, root)->left = c; }
+    else { int c = avl_insert(ix, NODE(ix, root)->right, n); NODE(ix, root)->right = c; }
+    return rebalance(ix, root);
+}
+
+// -------------------- per-player best table --------------------
+static unsigned name_hash(const char *s) {
+    unsigned h = 2166136261u;
+    while (*s) { h ^= (unsigned char)*s++; h *= 16777619u; }
+    return h;
+}
+
+static int *best_slot(const ScoreIndex *ix, const char *name) {
+    unsigned mask = (unsigned)ix->bestCap - 1, h = name_hash(name) & mask;
+    while (ix->best[h] >= 0 && strcmp(ix->pool[ix->best[h]].name, name) != 0) h = (h + 1) & mask;
+    return &ix->best[h];
+}
+
+static int best_grow(ScoreIndex *ix) {
+    int oldCap = ix->bestCap, *old = ix->best;
+    int cap = oldCap ? oldCap * 2 : 64;
+    int *t = malloc(sizeof(int) * cap);
+    if (!t) return 0;
+    memset(t, -1, sizeof(int) * cap);
+    ix->best = t; ix->bestCap = cap;
+    for (int i = 0; i < oldCap; i++) if (old[i] >= 0) *best_slot(ix, ix->pool[old[i]].name) = old[i];
+    free(old);
+    return 1;
+}
+
+// returns the new node's pool index, or -1 if out of memory
+int scoreindex_insert(ScoreIndex *ix, const char *name, int score) {
+    if (ix->count == ix->cap) {
+        int cap = ix->cap ? ix->cap * 2 : 256;
+        ScoreNode *p = realloc(ix->pool, sizeof(ScoreNode) * cap);
+        if (!p) return -1;
+        ix->pool = p; ix->cap = cap;
+    }
+    if ((ix->bestCount + 1) * 4 > ix->bestCap * 3 && !best_grow(ix)) return -1;
+
+    int i = ix->count++;
+    ScoreNode *n = NODE(ix, i);
+    strncpy(n->name, name, MAX_NAME_LEN);
+    n->name[MAX_NAME_LEN-1] = '\0';
+    n->score = score; n->seq = (unsigned)i;
+    n->left = n->right = -1; n->size = 1; n->height = 1;
+    n->difficulty = 0; n->timestamp = 0;
+    ix->root = avl_insert(ix, ix->root, i);
+
+    int *slot = best_slot(ix, n->name);
+    if (*slot < 0) { *slot = i; ix->bestCount++; }
+    else if (ix->pool[*slot].score < score) *slot = i;
+    return i;
+}
+
+// -------------------- queries --------------------
+// first n entries in leaderboard order, via an explicit-stack in-order walk
+int scoreindex_top(const ScoreIndex *ix, PlayerScore *out, int n) {
+    int stack[64], sp = 0, i = ix->root, k = 0;
+    while (k < n && (i >= 0 || sp > 0)) {
+        while (i >= 0) { stack[sp++] = i; i = ix->pool[i].left; }
+        i = stack[--sp];
+        memcpy(out[k].name, ix->pool[i].name, MAX_NAME_LEN);
+        out[k].score = ix->pool[i].score;
+        k++;
+        i = ix->pool[i].right;
+    }
+    return k;
+}
+
+// k-th entry (0-based) in leaderboard order
+const ScoreNode* scoreindex_select(const ScoreIndex *ix, int k) {
+    int i = ix->root;
+    while (i >= 0) {
+        int ls = SIZE(ix, ix->pool[i].left);
+        if (k < ls) i = ix->pool[i].left;
+        else if (k == ls) return &ix->pool[i];
+        else { k -= ls + 1; i = ix->pool[i].right; }
+    }
+    return NULL;
+}
+
+// number of entries with a score strictly greater than `score`
+int scoreindex_count_above(const ScoreIndex *ix, int score) {
+    int i = ix->root, c = 0;
+    while (i >= 0) {
+        if (ix->pool[i].score > score) { c += SIZE(ix, ix->pool[i].left) + 1; i = ix->pool[i].right; }
+        else i = ix->pool[i].left;
+    }
+    return c;
+}
+
+// rank `score` would take on the board (1 = top); ties share the better rank
+int scoreindex_rank(const ScoreIndex *ix, int score) {
+    return scoreindex_count_above(ix, score) + 1;
+}
+
+// entries with lo <= score <= hi
+int scoreindex_count_between(const ScoreIndex *ix, int lo, int hi) {
+    if (lo > hi) return 0;
+    return scoreindex_count_above(ix, lo - 1) - scoreindex_count_above(ix, hi);
+}
+
+const ScoreNode* scoreindex_best(const ScoreIndex *ix, const char *name) {
+    if (!ix->bestCap) return NULL;
+    int i = *best_slot(ix, name);
+    return i < 0 ? NULL : &ix->pool[i];
+}
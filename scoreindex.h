@@ -0,0 +1,46 @@
+#ifndef SCOREINDEX_H
+#define SCOREINDEX_H
+
+#define MAX_NAME_LEN 30
+
+typedef struct {
+    char name[MAX_NAME_LEN];
+    int score;
+} PlayerScore;
+
+// Size-augmented AVL tree over leaderboard entries, ordered by score
+// (descending) then insertion order, so in-order == leaderboard order.
+// Nodes live in a growable pool and link by index; a per-player hash
+// table points at each player's best node.
+typedef struct ScoreNode {
+    char name[MAX_NAME_LEN];
+    int score;
+    unsigned seq;          // insertion order, breaks ties
+    int left, right;       // pool indices, -1 = none
+    int size;              // nodes in this subtree
+    int height;
+    int difficulty;        // record metadata, carried for the log writer
+    long long timestamp;
+} ScoreNode;
+
+typedef struct ScoreIndex {
+    ScoreNode *pool;
+    int count, cap;
+    int root;
+    int *best;             // open-addressing table of node indices, -1 = empty
+    int bestCap, bestCount;
+} ScoreIndex;
+
+void scoreindex_init(ScoreIndex *ix);
+void scoreindex_reset(ScoreIndex *ix);
+void scoreindex_free(ScoreIndex *ix);
+int scoreindex_insert(ScoreIndex *ix, const char *name, int score);
+
+int scoreindex_top(const ScoreIndex *ix, PlayerScore *out, int n);
+const ScoreNode* scoreindex_select(const ScoreIndex *ix, int k);
+int scoreindex_count_above(const ScoreIndex *ix, int score);
+int scoreindex_rank(const ScoreIndex *ix, int score);
+int scoreindex_count_between(const ScoreIndex *ix, int lo, int hi);
+const ScoreNode* scoreindex_best(const ScoreIndex *ix, const char *name);
+
+#endif
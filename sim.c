@@ -0,0 +1,256 @@
+// Batch simulator: plays N full games of the AI policy across all cores and
+// reports the score distribution, survival, death causes and throughput.
+//   snake_sim [-n games] [-j threads] [-d difficulty] [-s firstSeed] [-t maxTicks] [-g WxH] [-L layout]
+//             [-m rollouts]
+// -m plays the Monte-Carlo lookahead policy with that many rollouts per move
+// instead of the greedy one (single-threaded within each game, no time budget,
+// so results stay deterministic per seed).
+// With -a it runs one arena of that many snakes for -t ticks (single-threaded,
+// deterministic per seed) and reports tick throughput and death causes instead.
+#include "game.h"
+#include "ai.h"
+#include "lookahead.h"
+#include "arena.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#define MAX_THREADS 256
+
+// Each worker owns a range of game indices and takes from its front; an idle
+// worker steals the back half of another worker's range. Ranges only shrink,
+// so once every range is empty all games have been handed out.
+typedef struct {
+    pthread_mutex_t lock;
+    long next, end;
+} WorkRange;
+
+typedef struct {
+    int id;
+    long deaths[DEATH_CAUSES];
+    long timeouts;
+    long steals;
+    int failed;               // couldn't set up its game state; played nothing
+} Worker;
+
+static WorkRange ranges[MAX_THREADS];
+static Worker workers[MAX_THREADS];
+static int threadCount = 1;
+static int difficulty = 1;
+static uint64_t firstSeed = 1;
+static int maxTicks = 200000;
+static int gridWidth = GRID_WIDTH, gridHeight = GRID_HEIGHT;
+static int layout = LAYOUT_DEFAULT;
+static int lookaheadRollouts;
+static int *scores;
+static int *survival;
+
+static int take_own(int id, long *out) {
+    WorkRange *r = &ranges[id];
+    int ok = 0;
+    pthread_mutex_lock(&r->lock);
+    if (r->next < r->end) { *out = r->next++; ok = 1; }
+    pthread_mutex_unlock(&r->lock);
+    return ok;
+}
+
+static int steal(int id) {
+    for (int k = 1; k < threadCount; k++) {
+        WorkRange *v = &ranges[(id + k) % threadCount];
+        long lo = 0, hi = 0;
+        pthread_mutex_lock(&v->lock);
+        long left = v->end - v->next;
+        if (left > 0) {
+            lo = v->end - (left + 1) / 2; hi = v->end;
+            v->end = lo;
+        }
+        pthread_mutex_unlock(&v->lock);
+        if (hi > lo) {
+            WorkRange *r = &ranges[id];
+            pthread_mutex_lock(&r->lock);
+            r->next = lo; r->end = hi;
+            pthread_mutex_unlock(&r->lock);
+            workers[id].steals++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void *worker_main(void *arg) {
+    Worker *w = arg;
+    GameState g;
+    PathFinder pf;
+    Lookahead la;
+    if (!game_init_layout(&g, gridWidth, gridHeight, firstSeed, difficulty, layout)) { w->failed = 1; return NULL; }
+    if (!path_init(&pf, g.board.width, g.board.height)) { game_free(&g); w->failed = 1; return NULL; }
+    if (lookaheadRollouts && !lookahead_init(&la, 0, &g)) { path_free(&pf); game_free(&g); w->failed = 1; return NULL; }
+    long i;
+    for (;;) {
+        if (!take_own(w->id, &i)) {
+            if (!steal(w->id)) break;
+            continue;
+        }
+        game_reseed(&g, firstSeed + (uint64_t)i);
+        while (!g.gameOver && g.tick < maxTicks) {
+            int action = lookaheadRollouts ? lookahead_choose(&la, &g, 1e9, lookaheadRollouts) : ai_choose(&pf, &g);
+            int ev = game_step(&g, action);
+            if (ev & (EV_LIFE_LOST | EV_GAME_OVER)) w->deaths[g.lastDeath]++;
+        }
+        if (!g.gameOver) w->timeouts++;
+        scores[i] = g.score;
+        survival[i] = g.tick;
+    }
+    if (lookaheadRollouts) lookahead_free(&la);
+    path_free(&pf);
+    game_free(&g);
+    return NULL;
+}
+
+static int cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO si; GetSystemInfo(&si);
+    return (int)si.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int cmp_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static int run_arena(int snakes, int ticks) {
+    Arena a;
+    if (!arena_init(&a, gridWidth, gridHeight, snakes, 0, firstSeed, layout)) {
+        fprintf(stderr, "can't set up a %dx%d arena with %d snakes\n", gridWidth, gridHeight, snakes);
+        return 1;
+    }
+    long long aliveSum = 0;
+    double start = now_seconds();
+    for (int t = 0; t < ticks; t++) { arena_step(&a, NULL); aliveSum += a.alive; }
+    double elapsed = now_seconds() - start;
+
+    long long best = 0, total = 0;
+    for (int i = 0; i < a.count; i++) { total += a.score[i]; if (a.score[i] > best) best = a.score[i]; }
+    printf("arena        %d snakes, %d fruit (%dx%d %s, seed %llu)\n", a.count, a.fruitCount,
+           gridWidth, gridHeight, level_name(layout), (unsigned long long)firstSeed);
+    printf("throughput   %.0f ticks/s, %.2f Msnake-ticks/s (%d ticks in %.2fs)\n",
+           ticks / elapsed, (double)aliveSum / elapsed / 1e6, ticks, elapsed);
+    printf("alive        mean %.1f\n", (double)aliveSum / ticks);
+    printf("score        total %lld  best %lld\n", total, best);
+    printf("deaths       wall %lld  body %lld  head-on %lld\n",
+           a.deaths[ARENA_DEATH_WALL], a.deaths[ARENA_DEATH_BODY], a.deaths[ARENA_DEATH_HEAD_ON]);
+    arena_free(&a);
+    return 0;
+}
+
+static int usage(const char *prog) {
+    fprintf(stderr, "usage: %s [-n games] [-j threads] [-d 1|2|3] [-s seed] [-t maxTicks] [-g WxH] "
+            "[-L open|scatter|maze] [-a arenaSnakes] [-m rollouts]\n", prog);
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    long games = 10000;
+    int arenaSnakes = 0;
+    threadCount = cpu_count();
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 == argc) return usage(argv[0]); // every option takes a value
+        if (!strcmp(argv[i], "-n")) games = atol(argv[i+1]);
+        else if (!strcmp(argv[i], "-j")) threadCount = atoi(argv[i+1]);
+        else if (!strcmp(argv[i], "-d")) difficulty = atoi(argv[i+1]);
+        else if (!strcmp(argv[i], "-s")) firstSeed = strtoull(argv[i+1], NULL, 10);
+        else if (!strcmp(argv[i], "-t")) maxTicks = atoi(argv[i+1]);
+        else if (!strcmp(argv[i], "-g") && sscanf(argv[i+1], "%dx%d", &gridWidth, &gridHeight) == 2) continue;
+        else if (!strcmp(argv[i], "-L") && (layout = level_parse(argv[i+1])) >= 0) continue;
+        else if (!strcmp(argv[i], "-a") && (arenaSnakes = atoi(argv[i+1])) > 0) continue;
+        else if (!strcmp(argv[i], "-m") && (lookaheadRollouts = atoi(argv[i+1])) > 0) continue;
+        else return usage(argv[0]);
+    }
+    if (arenaSnakes) return run_arena(arenaSnakes, maxTicks);
+    if (gridWidth < GRID_MIN || gridHeight < GRID_MIN || gridWidth > GRID_MAX || gridHeight > GRID_MAX) {
+        fprintf(stderr, "grid must be between %dx%d and %dx%d\n", GRID_MIN, GRID_MIN, GRID_MAX, GRID_MAX);
+        return 2;
+    }
+    if (games < 1) games = 1;
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > MAX_THREADS) threadCount = MAX_THREADS;
+
+    scores = malloc(sizeof(int) * games);
+    survival = malloc(sizeof(int) * games);
+    if (!scores || !survival) { fprintf(stderr, "out of memory\n"); return 1; }
+
+    // initial even split; stealing evens out long games
+    for (int t = 0; t < threadCount; t++) {
+        pthread_mutex_init(&ranges[t].lock, NULL);
+        ranges[t].next = games * t / threadCount;
+        ranges[t].end = games * (t + 1) / threadCount;
+        workers[t].id = t;
+    }
+
+    double start = now_seconds();
+    pthread_t th[MAX_THREADS];
+    int started = 0;
+    while (started < threadCount && pthread_create(&th[started], NULL, worker_main, &workers[started]) == 0) started++;
+    for (int t = 0; t < started; t++) pthread_join(th[t], NULL);
+    double elapsed = now_seconds() - start;
+    if (started < threadCount) {
+        // the ones that ran may have stolen its games, but not necessarily all of them
+        fprintf(stderr, "couldn't start worker %d of %d\n", started + 1, threadCount);
+        free(scores); free(survival);
+        return 1;
+    }
+    for (int t = 0; t < threadCount; t++) {
+        if (!workers[t].failed) continue;
+        // its games may have been stolen, but not necessarily all of them
+        fprintf(stderr, "worker %d couldn't set up a %dx%d game\n", t, gridWidth, gridHeight);
+        free(scores); free(survival);
+        return 1;
+    }
+
+    long deaths[DEATH_CAUSES] = {0}, timeouts = 0, steals = 0;
+    long long totalTicks = 0, totalScore = 0;
+    for (int t = 0; t < threadCount; t++) {
+        for (int c = 0; c < DEATH_CAUSES; c++) deaths[c] += workers[t].deaths[c];
+        timeouts += workers[t].timeouts; steals += workers[t].steals;
+    }
+    for (long i = 0; i < games; i++) { totalTicks += survival[i]; totalScore += scores[i]; }
+    qsort(scores, games, sizeof(int), cmp_int);
+#define PCT(p) scores[(long)((games - 1) * (p) / 100.0)]
+
+    printf("games        %ld (%dx%d %s, difficulty %d, seeds %llu..%llu, %d threads, %ld steals)\n",
+           games, gridWidth, gridHeight, level_name(layout), difficulty, (unsigned long long)firstSeed, (unsigned long long)(firstSeed + games - 1), threadCount, steals);
+    if (lookaheadRollouts) printf("policy       lookahead, %d rollouts of %d ticks per move\n", lookaheadRollouts, LOOKAHEAD_DEPTH);
+    printf("throughput   %.0f games/s, %.2f Mticks/s (%.2fs)\n", games / elapsed, totalTicks / elapsed / 1e6, elapsed);
+    printf("score        mean %.1f  min %d  p10 %d  p50 %d  p90 %d  p99 %d  max %d\n",
+           (double)totalScore / games, scores[0], PCT(10), PCT(50), PCT(90), PCT(99), scores[games-1]);
+    printf("survival     mean %.1f ticks\n", (double)totalTicks / games);
+    printf("deaths       wall %ld  self %ld  boundary %ld  (timeouts %ld at %d ticks)\n",
+           deaths[DEATH_WALL], deaths[DEATH_SELF], deaths[DEATH_BOUNDARY], timeouts, maxTicks);
+
+    // 10-bucket score histogram
+    int top = scores[games-1] + 1;
+    long hist[10] = {0};
+    for (long i = 0; i < games; i++) hist[(long long)scores[i] * 10 / top]++;
+    for (int b = 0; b < 10; b++)
+        printf("  %6d-%-6d %ld\n", (int)((long long)top * b / 10), (int)((long long)top * (b + 1) / 10) - 1, hist[b]);
+
+    free(scores); free(survival);
+    return 0;
+}
@@ -1,70 +1,71 @@
-#include "raylib.h"
 #include "snake.h"
 #include <stdlib.h>
 
-Snake* create_snake(int startX, int startY) {
+Snake* create_snake(int startX, int startY, Board *board) {
     Snake* snake = (Snake*)malloc(sizeof(Snake));
-    Node* head = (Node*)malloc(sizeof(Node));
-    head->x = startX;
-    head->y = startY;
-    head->next = NULL;
-    snake->head = head;
-    snake->direction = 1; // Start moving right
+    if (!snake) return NULL;
+    Cell *body = (Cell*)malloc(sizeof(Cell) * snake_capacity(board));
+    if (!body) { free(snake); return NULL; }
+    snake_init(snake, body, board, startX, startY);
     return snake;
 }
 
+// set up a snake in caller-owned storage; `body` holds snake_capacity(board) cells
+void snake_init(Snake* snake, Cell *body, Board *board, int startX, int startY) {
+    snake->body = body;
+    snake->capacity = snake_capacity(board);
+    snake->board = board;
+    snake->head = 0; snake->length = 0;
+    reset_snake(snake, startX, startY);
+}
+
+// back to a one-cell snake at the start, reusing the body buffer (respawns don't allocate)
+void reset_snake(Snake* snake, int startX, int startY) {
+    SNAKE_FOR_EACH(snake, c, board_clear(snake->board, LAYER_SNAKE, CELL_X(c), CELL_Y(c)));
+    snake->head = 0;
+    snake->length = 1;
+    snake->body[0] = CELL_PACK(startX, startY);
+    snake->direction = 1; // Start moving right
+    snake->bitten = 0;
+    board_set(snake->board, LAYER_SNAKE, startX, startY);
+}
+
 void move_snake(Snake* snake, int grow) {
-    Node* newHead = (Node*)malloc(sizeof(Node));
-    newHead->x = snake->head->x;
-    newHead->y = snake->head->y;
+    int x = snake_head_x(snake);
+    int y = snake_head_y(snake);
 
     switch (snake->direction) {
-        case 0: newHead->y -= 1; break;
-        case 1: newHead->x += 1; break;
-        case 2: newHead->y += 1; break;
-        case 3: newHead->x -= 1; break;
+        case 0: y -= 1; break;
+        case 1: x += 1; break;
+        case 2: y += 1; break;
+        case 3: x -= 1; break;
     }
 
-    newHead->next = snake->head;
-    snake->head = newHead;
-
-    if (!grow) {
-        Node* temp = snake->head;
-        while (temp->next && temp->next->next)
-            temp = temp->next;
-        free(temp->next);
-        temp->next = NULL;
+    // pop tail first (O(1)), then push the new head one slot "before" the old one
+    if (!grow || snake->length == snake->capacity) {
+        Cell tail = snake_segment(snake, snake->length - 1);
+        board_clear(snake->board, LAYER_SNAKE, CELL_X(tail), CELL_Y(tail));
+        snake->length--;
     }
-}
+    snake->head = snake->head == 0 ? snake->capacity - 1 : snake->head - 1;
+    snake->body[snake->head] = CELL_PACK(x, y);
+    snake->length++;
 
-void draw_snake(Snake* snake, int cellSize) {
-    Node* current = snake->head;
-    while (current) {
-        DrawRectangle(current->x * cellSize, current->y * cellSize, cellSize, cellSize, GREEN);
-        current = current->next;
-    }
+    // self collision is the bit test on the new head, taken before marking it
+    snake->bitten = board_test(snake->board, LAYER_SNAKE, x, y);
+    board_set(snake->board, LAYER_SNAKE, x, y);
 }
 
 int check_collision(Snake* snake, int width, int height) {
-    Node* head = snake->head;
-    if (head->x < 0 || head->x >= width || head->y < 0 || head->y >= height)
+    int hx = snake_head_x(snake), hy = snake_head_y(snake);
+    if (hx < 0 || hx >= width || hy < 0 || hy >= height)
         return 1;
 
-    Node* body = head->next;
-    while (body) {
-        if (body->x == head->x && body->y == head->y)
-            return 1;
-        body = body->next;
-    }
-    return 0;
+    return snake->bitten;
 }
 
 void free_snake(Snake* snake) {
-    Node* current = snake->head;
-    while (current) {
-        Node* temp = current;
-        current = current->next;
-        free(temp);
-    }
+    SNAKE_FOR_EACH(snake, c, board_clear(snake->board, LAYER_SNAKE, CELL_X(c), CELL_Y(c)));
+    free(snake->body);
     free(snake);
 }
@@ -1,20 +1,54 @@
 #ifndef SNAKE_H
 #define SNAKE_H
 
-typedef struct Node {
-    int x, y;
-    struct Node* next;
-} Node;
+#include "board.h"
 
+// Packed grid coordinate: x in the low 16 bits, y in the high 16 bits.
+// Unpacking sign-extends, so a head that stepped off the board reads back as -1.
+typedef unsigned int Cell;
+#define CELL_PACK(x, y) ((Cell)((((unsigned)(y) & 0xFFFFu) << 16) | ((unsigned)(x) & 0xFFFFu)))
+#define CELL_X(c) ((int)(short)((c) & 0xFFFFu))
+#define CELL_Y(c) ((int)(short)((c) >> 16))
+
+// Snake body is a fixed-capacity ring buffer sized to the grid.
+// body[head] is the head, the following `length` slots (wrapping) run towards the tail.
+// The snake keeps its cells marked on the board's LAYER_SNAKE as it moves.
 typedef struct Snake {
-    Node* head;
+    Cell *body;
+    int capacity;
+    int head;
+    int length;
     int direction; // 0=UP, 1=RIGHT, 2=DOWN, 3=LEFT
+    int bitten;    // last move landed on a cell the body still occupied
+    Board *board;
 } Snake;
 
-Snake* create_snake(int startX, int startY);
+Snake* create_snake(int startX, int startY, Board *board);
+void snake_init(Snake* snake, Cell *body, Board *board, int startX, int startY);
 void move_snake(Snake* snake, int grow);
 int check_collision(Snake* snake, int width, int height);
-void draw_snake(Snake* snake, int cellSize);
+void reset_snake(Snake* snake, int startX, int startY);
 void free_snake(Snake* snake);
 
+// one spare slot: a growing move pushes the head before the collision check
+static inline int snake_capacity(const Board *board) { return board->width * board->height + 1; }
+
+// i-th segment counted from the head (0 = head)
+static inline Cell snake_segment(const Snake *snake, int i) {
+    int k = snake->head + i;
+    if (k >= snake->capacity) k -= snake->capacity;
+    return snake->body[k];
+}
+#define snake_head_x(s) CELL_X((s)->body[(s)->head])
+#define snake_head_y(s) CELL_Y((s)->body[(s)->head])
+
+// Iterate the body as (at most) two contiguous spans: head..end of buffer, then the wrapped rest.
+#define SNAKE_FOR_EACH(snake, c, ...) do { \
+    const Snake *s_ = (snake); \
+    int n1_ = s_->capacity - s_->head; if (n1_ > s_->length) n1_ = s_->length; \
+    const Cell *p_ = s_->body + s_->head; \
+    for (int i_ = 0; i_ < n1_; i_++) { Cell c = p_[i_]; __VA_ARGS__; } \
+    for (int i_ = 0; i_ < s_->length - n1_; i_++) { Cell c = s_->body[i_]; __VA_ARGS__; } \
+} while (0)
+
 #endif
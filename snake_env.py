@@ -0,0 +1,96 @@
+"""ctypes binding for the vectorized snake environment (vecenv.c).
+
+Build the library with `make vecenv` (snakeenv.dll; on Linux/macOS build
+libsnakeenv.so the same way with -fPIC), then:
+
+    env = SnakeVecEnv(64, difficulty=2)
+    grid, pos = env.reset()
+    (grid, pos), reward, done = env.step(actions)   # actions: int array of shape (64,)
+
+The observation, reward and done arrays are allocated once here and filled
+in place by the C side on every step; the returned arrays are those same
+buffers, so copy them if you need to keep a step's values. Games that finish
+are reset automatically and their next observation is the new game's first;
+env.final_score(i) gives the score of the game that just ended.
+"""
+import ctypes
+import os
+
+import numpy as np
+
+VEC_POS = 8
+CELL_EMPTY, CELL_WALL, CELL_BODY, CELL_HEAD, CELL_FOOD, CELL_BONUS, CELL_POWER = range(7)
+LAYOUTS = {"default": 0, "open": 1, "scatter": 2, "maze": 3}
+
+
+def _load(path=None):
+    here = os.path.dirname(os.path.abspath(__file__))
+    candidates = [path or os.environ.get("SNAKE_ENV_LIB")] + [
+        os.path.join(here, name) for name in ("snakeenv.dll", "libsnakeenv.so", "libsnakeenv.dylib")]
+    for c in candidates:
+        if c and os.path.exists(c):
+            lib = ctypes.CDLL(c)
+            break
+    else:
+        raise OSError("snake env library not found; run `make vecenv` or set SNAKE_ENV_LIB")
+
+    u8p, i32p, f32p = (ctypes.POINTER(t) for t in (ctypes.c_uint8, ctypes.c_int32, ctypes.c_float))
+    lib.vec_env_create.restype = ctypes.c_void_p
+    lib.vec_env_create.argtypes = [ctypes.c_int] * 5 + [ctypes.c_uint64, ctypes.c_int]
+    lib.vec_env_set_buffers.restype = None
+    lib.vec_env_set_buffers.argtypes = [ctypes.c_void_p, u8p, i32p, f32p, u8p]
+    lib.vec_env_reset.restype = ctypes.c_int
+    lib.vec_env_reset.argtypes = [ctypes.c_void_p]
+    lib.vec_env_step.restype = ctypes.c_int
+    lib.vec_env_step.argtypes = [ctypes.c_void_p, i32p]
+    lib.vec_env_score.restype = ctypes.c_int
+    lib.vec_env_score.argtypes = [ctypes.c_void_p, ctypes.c_int]
+    lib.vec_env_free.restype = None
+    lib.vec_env_free.argtypes = [ctypes.c_void_p]
+    return lib
+
+
+class SnakeVecEnv:
+    def __init__(self, num_envs, width=30, height=20, difficulty=1, layout="default", seed=1,
+                 max_ticks=0, lib=None):
+        self._lib = _load(lib)
+        self.num_envs, self.width, self.height = num_envs, width, height
+        self._env = self._lib.vec_env_create(num_envs, width, height, difficulty,
+                                             LAYOUTS.get(layout, layout), seed, max_ticks)
+        if not self._env:
+            raise ValueError("invalid environment parameters")
+
+        self.grid = np.zeros((num_envs, height, width), dtype=np.uint8)
+        self.pos = np.zeros((num_envs, VEC_POS), dtype=np.int32)
+        self.reward = np.zeros(num_envs, dtype=np.float32)
+        self.done = np.zeros(num_envs, dtype=np.uint8)
+        self._actions = np.full(num_envs, -1, dtype=np.int32)
+        self._lib.vec_env_set_buffers(self._env, self._ptr(self.grid, ctypes.c_uint8),
+                                      self._ptr(self.pos, ctypes.c_int32),
+                                      self._ptr(self.reward, ctypes.c_float),
+                                      self._ptr(self.done, ctypes.c_uint8))
+
+    @staticmethod
+    def _ptr(a, ctype):
+        return a.ctypes.data_as(ctypes.POINTER(ctype))
+
+    def reset(self):
+        self._lib.vec_env_reset(self._env)
+        return self.grid, self.pos
+
+    def step(self, actions):
+        """actions: one of 0=up, 1=right, 2=down, 3=left or -1 (keep going) per game."""
+        self._actions[:] = actions
+        self._lib.vec_env_step(self._env, self._ptr(self._actions, ctypes.c_int32))
+        return (self.grid, self.pos), self.reward, self.done
+
+    def final_score(self, i):
+        return self._lib.vec_env_score(self._env, i)
+
+    def close(self):
+        if self._env:
+            self._lib.vec_env_free(self._env)
+            self._env = None
+
+    def __del__(self):
+        self.close()
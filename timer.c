@@ -0,0 +1,38 @@
+#include "timer.h"
+
+#define SLOT(tick) ((tick) & (TIMER_SLOTS - 1))
+
+void timer_clear(TimerWheel *w) {
+    for (int s = 0; s < TIMER_SLOTS; s++) w->head[s] = -1;
+    for (int i = 0; i < TIMER_MAX; i++) { w->next[i] = w->prev[i] = -1; w->due[i] = -1; }
+}
+
+void timer_cancel(TimerWheel *w, int id) {
+    if (w->due[id] < 0) return;
+    if (w->prev[id] >= 0) w->next[w->prev[id]] = w->next[id];
+    else w->head[SLOT(w->due[id])] = w->next[id];
+    if (w->next[id] >= 0) w->prev[w->next[id]] = w->prev[id];
+    w->next[id] = w->prev[id] = -1;
+    w->due[id] = -1;
+}
+
+// arm timer `id` to fire on `tick`, replacing any earlier setting
+void timer_set(TimerWheel *w, int id, int tick) {
+    timer_cancel(w, id);
+    int s = SLOT(tick);
+    w->due[id] = tick;
+    w->next[id] = w->head[s];
+    if (w->head[s] >= 0) w->prev[w->head[s]] = (int16_t)id;
+    w->head[s] = (int16_t)id;
+}
+
+// Disarm and return one timer due on `tick`, or -1 once there are none;
+// call until -1 each tick.
+int timer_pop(TimerWheel *w, int tick) {
+    for (int i = w->head[SLOT(tick)]; i >= 0; i = w->next[i]) {
+        if (w->due[i] != tick) continue;
+        timer_cancel(w, i);
+        return i;
+    }
+    return -1;
+}
@@ -0,0 +1,28 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+
+// Hashed timer wheel over game ticks. Each timer has a fixed id, so the
+// wheel is a plain array with no pointers: it is copied along with the game
+// by snapshots and clones. Arming, re-arming and cancelling are O(1); each
+// tick looks only at the slot its tick hashes to. A timer due more than
+// TIMER_SLOTS ticks out shares its slot with nearer ones and is skipped until
+// its own lap comes round.
+#define TIMER_SLOTS 256 // power of two; every current timer fits in one lap
+#define TIMER_MAX 8
+
+typedef struct TimerWheel {
+    int16_t head[TIMER_SLOTS];          // first timer per slot, -1 if none
+    int16_t next[TIMER_MAX], prev[TIMER_MAX];
+    int due[TIMER_MAX];                 // tick the timer fires on, -1 if not armed
+} TimerWheel;
+
+void timer_clear(TimerWheel *w);
+void timer_set(TimerWheel *w, int id, int tick);
+void timer_cancel(TimerWheel *w, int id);
+int timer_pop(TimerWheel *w, int tick);
+
+static inline int timer_armed(const TimerWheel *w, int id) { return w->due[id] >= 0; }
+
+#endif
@@ -0,0 +1,114 @@
+#include "vecenv.h"
+#include "game.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct VecEnv {
+    int count, width, height, difficulty, layout, maxTicks;
+    uint64_t nextSeed;        // seed for the next game to be reset
+    GameState *games;
+    int *lastScore;           // score of the finished game, until it is reset again
+    uint8_t *grid;            // caller-owned output buffers
+    int32_t *pos;
+    float *reward;
+    uint8_t *done;
+};
+
+VecEnv *vec_env_create(int count, int width, int height, int difficulty, int layout, uint64_t seed, int maxTicks) {
+    if (count < 1) return NULL;
+    VecEnv *env = calloc(1, sizeof(VecEnv));
+    if (!env) return NULL;
+    env->games = calloc(count, sizeof(GameState));
+    env->lastScore = calloc(count, sizeof(int));
+    if (!env->games || !env->lastScore) { vec_env_free(env); return NULL; }
+    env->width = width; env->height = height;
+    env->difficulty = difficulty; env->layout = layout;
+    env->maxTicks = maxTicks;
+    for (int i = 0; i < count; i++) {
+        if (!game_init_layout(&env->games[i], width, height, seed + i, difficulty, layout)) {
+            vec_env_free(env);
+            return NULL;
+        }
+        env->count++;
+    }
+    env->nextSeed = seed + count;
+    return env;
+}
+
+void vec_env_set_buffers(VecEnv *env, uint8_t *grid, int32_t *pos, float *reward, uint8_t *done) {
+    env->grid = grid; env->pos = pos; env->reward = reward; env->done = done;
+}
+
+static void put_fruit(uint8_t *grid, int32_t *pos, const Fruit *f, int width, int code) {
+    if (!f->active) { pos[0] = pos[1] = -1; return; }
+    pos[0] = f->x; pos[1] = f->y;
+    grid[f->y * width + f->x] = (uint8_t)code;
+}
+
+// expand the board's bit layers into the byte plane, then stamp the head and fruit
+static void observe(const VecEnv *env, int i) {
+    const GameState *g = &env->games[i];
+    const Board *b = &g->board;
+    int cells = env->width * env->height;
+    uint8_t *grid = env->grid + (size_t)i * cells;
+    int32_t *pos = env->pos + (size_t)i * VEC_POS;
+    for (int w = 0; w < b->words; w++) {
+        uint64_t wall = b->layer[LAYER_WALL][w], body = b->layer[LAYER_SNAKE][w];
+        int base = w * 64, n = cells - base < 64 ? cells - base : 64;
+        for (int k = 0; k < n; k++) {
+            grid[base + k] = (wall >> k) & 1 ? VEC_CELL_WALL : (body >> k) & 1 ? VEC_CELL_BODY : VEC_CELL_EMPTY;
+        }
+    }
+    int hx = snake_head_x(&g->snake), hy = snake_head_y(&g->snake);
+    pos[0] = hx; pos[1] = hy;
+    if (board_in_bounds(b, hx, hy)) grid[hy * env->width + hx] = VEC_CELL_HEAD;
+    put_fruit(grid, pos + 2, &g->food, env->width, VEC_CELL_FOOD);
+    put_fruit(grid, pos + 4, &g->powerup[POWERUP_BONUS], env->width, VEC_CELL_BONUS);
+    put_fruit(grid, pos + 6, &g->powerup[POWERUP_SLOW], env->width, VEC_CELL_POWER);
+}
+
+// Start every game afresh and write the first observations. Returns 0 if the
+// buffers haven't been set.
+int vec_env_reset(VecEnv *env) {
+    if (!env->grid || !env->pos || !env->reward || !env->done) return 0;
+    for (int i = 0; i < env->count; i++) {
+        game_reseed(&env->games[i], env->nextSeed++);
+        env->reward[i] = 0; env->done[i] = 0;
+        observe(env, i);
+    }
+    return 1;
+}
+
+// One tick of every game. actions[i] is a direction (0=UP, 1=RIGHT, 2=DOWN,
+// 3=LEFT) or -1 to keep going. Returns the number of games that finished
+// (and were reset) on this step, or -1 if the buffers haven't been set.
+int vec_env_step(VecEnv *env, const int32_t *actions) {
+    if (!env->grid || !env->pos || !env->reward || !env->done) return -1;
+    int finished = 0;
+    for (int i = 0; i < env->count; i++) {
+        GameState *g = &env->games[i];
+        int before = g->score;
+        game_step(g, actions[i]);
+        env->reward[i] = (float)(g->score - before);
+        env->done[i] = g->gameOver || (env->maxTicks > 0 && g->tick >= env->maxTicks);
+        if (env->done[i]) {
+            env->lastScore[i] = g->score;
+            game_reseed(g, env->nextSeed++);
+            finished++;
+        }
+        observe(env, i);
+    }
+    return finished;
+}
+
+// final score of game i's last finished episode (valid when done[i] was set)
+int vec_env_score(const VecEnv *env, int i) {
+    return i >= 0 && i < env->count ? env->lastScore[i] : 0;
+}
+
+void vec_env_free(VecEnv *env) {
+    if (!env) return;
+    for (int i = 0; env->games && i < env->count; i++) game_free(&env->games[i]);
+    free(env->games); free(env->lastScore);
+    free(env);
+}
@@ -0,0 +1,33 @@
+#ifndef VECENV_H
+#define VECENV_H
+
+#include <stdint.h>
+
+// Vectorized environment for training policies: K independent games stepped
+// in lockstep by one call. Observations, rewards and done flags are written
+// straight into buffers the caller owns (numpy arrays through ctypes, see
+// snake_env.py), so a step does no allocation and no copying on the Python
+// side. Finished games are reset in place with the next seed, and the
+// observation written for them is already the new game's first one.
+//
+// Per game, with W x H the board size:
+//   grid    uint8[H][W]  VEC_CELL_* codes
+//   pos     int32[VEC_POS]  head x,y  food x,y  bonus x,y  power x,y (-1,-1 if absent)
+//   reward  float        points scored this step: 10/20/15 x multiplier
+//   done    uint8        the game ended (out of lives, or maxTicks reached)
+enum {
+    VEC_CELL_EMPTY = 0, VEC_CELL_WALL, VEC_CELL_BODY, VEC_CELL_HEAD,
+    VEC_CELL_FOOD, VEC_CELL_BONUS, VEC_CELL_POWER
+};
+#define VEC_POS 8
+
+typedef struct VecEnv VecEnv;
+
+VecEnv *vec_env_create(int count, int width, int height, int difficulty, int layout, uint64_t seed, int maxTicks);
+void vec_env_set_buffers(VecEnv *env, uint8_t *grid, int32_t *pos, float *reward, uint8_t *done);
+int vec_env_reset(VecEnv *env);
+int vec_env_step(VecEnv *env, const int32_t *actions);
+int vec_env_score(const VecEnv *env, int i);
+void vec_env_free(VecEnv *env);
+
+#endif
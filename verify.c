@@ -0,0 +1,102 @@
+// Headless replay verifier: re-simulates every replay in a replay log at full
+// speed, checks each reproduces the score it claims, and optionally reports
+// how many leaderboard entries are backed by a verified replay.
+//   snake_verify [-r replays.dat] [-l leaderboard.dat] [-v]
+#include "replay.h"
+#include "leaderboard.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    int score;
+    char name[MAX_NAME_LEN];
+} Verified;
+
+static int cmp_verified(const void *a, const void *b) {
+    const Verified *x = a, *y = b;
+    if (x->score != y->score) return (x->score > y->score) - (x->score < y->score);
+    return strcmp(x->name, y->name);
+}
+
+static double now_seconds(void) {
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char **argv) {
+    const char *replayPath = "replays.dat", *boardPath = NULL;
+    int verbose = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-r") && i + 1 < argc) replayPath = argv[++i];
+        else if (!strcmp(argv[i], "-l") && i + 1 < argc) boardPath = argv[++i];
+        else if (!strcmp(argv[i], "-v")) verbose = 1;
+        else { fprintf(stderr, "usage: %s [-r replays.dat] [-l leaderboard.dat] [-v]\n", argv[0]); return 2; }
+    }
+
+    FILE *f = fopen(replayPath, "rb");
+    if (!f) { fprintf(stderr, "cannot open %s\n", replayPath); return 1; }
+
+    Replay r = {0};
+    Verified *ok = NULL;
+    long okCount = 0, okCap = 0, total = 0, damaged = 0, mismatched = 0;
+    long long ticks = 0;
+    double start = now_seconds();
+    for (int rc; (rc = replay_read(f, &r)) != 0; ) {
+        total++;
+        if (rc < 0) { damaged++; printf("#%ld damaged record skipped\n", total - 1); continue; }
+        int score, played;
+        int res = replay_run(&r, &score, &played);
+        ticks += played;
+        if (res != 1) {
+            mismatched++;
+            printf("#%ld %-*s claimed %d in %d ticks, replays to %d in %d ticks\n",
+                   total - 1, MAX_NAME_LEN, r.name, r.score, r.ticks, score, played);
+            continue;
+        }
+        if (verbose) printf("#%ld %-*s %d ok\n", total - 1, MAX_NAME_LEN, r.name, score);
+        if (okCount == okCap) {
+            okCap = okCap ? okCap * 2 : 256;
+            Verified *p = realloc(ok, sizeof(Verified) * okCap);
+            if (!p) { fprintf(stderr, "out of memory\n"); return 1; }
+            ok = p;
+        }
+        ok[okCount].score = score;
+        memcpy(ok[okCount].name, r.name, MAX_NAME_LEN);
+        okCount++;
+    }
+    fclose(f);
+    replay_free(&r);
+    double elapsed = now_seconds() - start;
+
+    printf("replays      %ld  verified %ld  mismatched %ld  damaged %ld\n", total, okCount, mismatched, damaged);
+    printf("throughput   %.0f replays/s, %.2f Mticks/s\n",
+           elapsed > 0 ? total / elapsed : 0.0, elapsed > 0 ? ticks / elapsed / 1e6 : 0.0);
+
+    // leaderboard entries with a matching (name, score) verified replay;
+    // the log is only read, never locked or compacted
+    if (boardPath) {
+        Leaderboard lb = {0};
+        leaderboard_open_readonly(&lb, boardPath);
+        qsort(ok, okCount, sizeof(Verified), cmp_verified);
+        int backed = 0, topBacked = 0;
+        for (int i = 0; i < lb.index.count; i++) {
+            Verified key = { lb.index.pool[i].score, "" };
+            memcpy(key.name, lb.index.pool[i].name, MAX_NAME_LEN);
+            if (okCount && bsearch(&key, ok, okCount, sizeof(Verified), cmp_verified)) backed++;
+        }
+        for (int k = 0; k < lb.count; k++) {
+            Verified key = { lb.top[k].score, "" };
+            memcpy(key.name, lb.top[k].name, MAX_NAME_LEN);
+            int has = okCount && bsearch(&key, ok, okCount, sizeof(Verified), cmp_verified);
+            topBacked += has;
+            if (!has) printf("top-%d entry %s %d has no verified replay\n", k + 1, key.name, key.score);
+        }
+        printf("leaderboard  %d entries, %d backed by a verified replay (top %d: %d/%d)\n",
+               lb.index.count, backed, LEADERBOARD_TOP, topBacked, lb.count);
+        leaderboard_free(&lb);
+    }
+
+    free(ok);
+    return mismatched || damaged ? 1 : 0;
+}